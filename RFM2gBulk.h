@@ -0,0 +1,95 @@
+/**
+ * @file RFM2gBulk.h
+ * @brief Header file for the RFM2g bulk channel
+ * @date 08/03/2021
+ * @authors Davide Liuzza, Luca Boncagni,  Cristian Galperti
+ *
+ *
+ * @copyright Copyright 2021 FSN-ENEA | Nuclear and Fusion Energy Department, ENEA Frascati (Rome)
+ * Italy.
+ * @copyright Copyright 2019 SPC | Swiss Plasma Center, EPFL Lausanne
+ * Switzerland.
+ * @copyright Copyright 2015 F4E | European Joint Undertaking for ITER and
+ * the Development of Fusion Energy ('Fusion for Energy').
+ * Licensed under the EUPL, Version 1.1 or - as soon they will be approved
+ * by the European Commission - subsequent versions of the EUPL (the "Licence")
+ * You may not use this work except in compliance with the Licence.
+ * You may obtain a copy of the Licence at: http://ec.europa.eu/idabc/eupl
+ *
+ * @warning Unless required by applicable law or agreed to in writing,
+ * software distributed under the Licence is distributed on an "AS IS"
+ * basis, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+ * or implied. See the Licence permissions and limitations under the Licence.
+
+ * @details This header file contains the layout of the bulk channel regions that the RFM2g DataSource
+ * uses to move large blobs between the nodes a fragment per cycle, and the state of their reassembly.
+ */
+
+#ifndef RFM2G_BULK_H_
+#define RFM2G_BULK_H_
+
+/*---------------------------------------------------------------------------*/
+/*                        Standard header includes                           */
+/*---------------------------------------------------------------------------*/
+
+/*---------------------------------------------------------------------------*/
+/*                        Project header includes                            */
+/*---------------------------------------------------------------------------*/
+#include "CompilerTypes.h"
+
+/*---------------------------------------------------------------------------*/
+/*                           Class declaration                               */
+/*---------------------------------------------------------------------------*/
+namespace MARTe {
+
+/**
+ * @brief The header of the bulk region of a host, followed by the blob.
+ * @details The sender writes a fragment of the blob and then bytesWritten and fragments. A new blob is announced by
+ * resetting bytesWritten and writing totalSize and crc before blobId. blobId 0 means no blob. A host with the channel
+ * enabled writes RFM2G_BULK_CHANNEL_MAGIC in channel: the receivers only follow the announced regions.
+ */
+struct RFM2gBulkHeader {
+    uint32 blobId;
+    uint32 totalSize;
+    uint32 crc; //CRC32C of the whole blob, checked by the receivers when complete
+    uint32 fragments; //sequence number of the last fragment written
+    uint32 bytesWritten;
+    uint32 channel; //RFM2G_BULK_CHANNEL_MAGIC while the host has the channel enabled
+    uint32 reserved[2];
+};
+
+/**
+ * The offsets of the header words in the bulk region
+ */
+const uint32 RFM2G_BULK_BLOB_ID_OFFSET = 0u;
+const uint32 RFM2G_BULK_TOTAL_SIZE_OFFSET = 4u;
+const uint32 RFM2G_BULK_CRC_OFFSET = 8u;
+const uint32 RFM2G_BULK_FRAGMENTS_OFFSET = 12u;
+const uint32 RFM2G_BULK_BYTES_WRITTEN_OFFSET = 16u;
+const uint32 RFM2G_BULK_CHANNEL_OFFSET = 20u;
+
+/**
+ * The channel word of an announced region ("BULK")
+ */
+const uint32 RFM2G_BULK_CHANNEL_MAGIC = 0x4B4C5542u;
+
+/**
+ * The reassembly of the blob of a host: the blob being received and the last complete one
+ */
+struct RFM2gBulkReceiveState {
+    uint32 blobId;
+    uint32 totalSize;
+    uint32 crc;
+    uint32 received;
+    uint32 completeId;
+    uint32 completeSize;
+    uint32 crcFailures;
+};
+
+}
+
+/*---------------------------------------------------------------------------*/
+/*                        Inline method definitions                          */
+/*---------------------------------------------------------------------------*/
+
+#endif /* RFM2G_BULK_H_ */
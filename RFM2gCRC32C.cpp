@@ -0,0 +1,165 @@
+/**
+ * @file RFM2gCRC32C.cpp
+ * @brief Source file for the RFM2gCRC32C functions
+ * @date 08/03/2021
+ * @authors Davide Liuzza, Luca Boncagni,  Cristian Galperti
+ *
+ *
+ * @copyright Copyright 2021 FSN-ENEA | Nuclear and Fusion Energy Department, ENEA Frascati (Rome)
+ * Italy.
+ * @copyright Copyright 2019 SPC | Swiss Plasma Center, EPFL Lausanne
+ * Switzerland.
+ * @copyright Copyright 2015 F4E | European Joint Undertaking for ITER and
+ * the Development of Fusion Energy ('Fusion for Energy').
+ * Licensed under the EUPL, Version 1.1 or - as soon they will be approved
+ * by the European Commission - subsequent versions of the EUPL (the "Licence")
+ * You may not use this work except in compliance with the Licence.
+ * You may obtain a copy of the Licence at: http://ec.europa.eu/idabc/eupl
+ *
+ * @warning Unless required by applicable law or agreed to in writing, 
+ * software distributed under the Licence is distributed on an "AS IS"
+ * basis, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+ * or implied. See the Licence permissions and limitations under the Licence.
+
+ * @details This source file contains the definition of the RFM2gCRC32C functions.
+ */
+
+#define DLL_API
+
+/*---------------------------------------------------------------------------*/
+/*                         Standard header includes                          */
+/*---------------------------------------------------------------------------*/
+#include <stdint.h>
+#include <string.h>
+
+/*---------------------------------------------------------------------------*/
+/*                         Project header includes                           */
+/*---------------------------------------------------------------------------*/
+#include "RFM2gCRC32C.h"
+
+/*---------------------------------------------------------------------------*/
+/*                           Static definitions                              */
+/*---------------------------------------------------------------------------*/
+namespace MARTe {
+
+namespace RFM2gCRC32C {
+
+/**
+ * Reflected Castagnoli polynomial
+ */
+static const uint32 CRC32C_POLYNOMIAL = 0x82F63B78u;
+
+/**
+ * Slicing-by-8 lookup tables
+ */
+static uint32 crcTable[8][256];
+
+/**
+ * True if the tables have been built
+ */
+static bool tablesReady = false;
+
+/**
+ * True if the SSE4.2 crc32 instruction is used
+ */
+static bool useHardware = false;
+
+static uint32 ComputeSoftware(uint32 crc,
+                              const uint8 *data,
+                              uint32 size) {
+    while ((size > 0u) && ((reinterpret_cast<uintptr_t>(data) & 7u) != 0u)) {
+        crc = crcTable[0][(crc ^ *data) & 0xFFu] ^ (crc >> 8);
+        data++;
+        size--;
+    }
+    while (size >= 8u) {
+        uint32 low;
+        uint32 high;
+        memcpy(&low, data, sizeof(uint32));
+        memcpy(&high, data + sizeof(uint32), sizeof(uint32));
+        low ^= crc;
+        crc = crcTable[7][low & 0xFFu] ^ crcTable[6][(low >> 8) & 0xFFu] ^ crcTable[5][(low >> 16) & 0xFFu] ^ crcTable[4][low >> 24]
+                ^ crcTable[3][high & 0xFFu] ^ crcTable[2][(high >> 8) & 0xFFu] ^ crcTable[1][(high >> 16) & 0xFFu] ^ crcTable[0][high >> 24];
+        data += 8u;
+        size -= 8u;
+    }
+    while (size > 0u) {
+        crc = crcTable[0][(crc ^ *data) & 0xFFu] ^ (crc >> 8);
+        data++;
+        size--;
+    }
+    return crc;
+}
+
+#if defined(__x86_64__)
+__attribute__((target("sse4.2")))
+static uint32 ComputeHardware(uint32 crc,
+                              const uint8 *data,
+                              uint32 size) {
+    while ((size > 0u) && ((reinterpret_cast<uintptr_t>(data) & 7u) != 0u)) {
+        crc = __builtin_ia32_crc32qi(crc, *data);
+        data++;
+        size--;
+    }
+    uint64 crc64 = crc;
+    while (size >= 8u) {
+        crc64 = __builtin_ia32_crc32di(crc64, *(reinterpret_cast<const uint64*>(data)));
+        data += 8u;
+        size -= 8u;
+    }
+    crc = static_cast<uint32>(crc64);
+    while (size > 0u) {
+        crc = __builtin_ia32_crc32qi(crc, *data);
+        data++;
+        size--;
+    }
+    return crc;
+}
+#endif
+
+bool Initialise() {
+    if (!tablesReady) {
+        uint32 i;
+        for (i = 0u; i < 256u; i++) {
+            uint32 crc = i;
+            uint32 j;
+            for (j = 0u; j < 8u; j++) {
+                crc = ((crc & 1u) != 0u) ? ((crc >> 1) ^ CRC32C_POLYNOMIAL) : (crc >> 1);
+            }
+            crcTable[0][i] = crc;
+        }
+        for (i = 0u; i < 256u; i++) {
+            uint32 j;
+            for (j = 1u; j < 8u; j++) {
+                crcTable[j][i] = (crcTable[j - 1u][i] >> 8) ^ crcTable[0][crcTable[j - 1u][i] & 0xFFu];
+            }
+        }
+#if defined(__x86_64__)
+        __builtin_cpu_init();
+        useHardware = (__builtin_cpu_supports("sse4.2") != 0);
+#endif
+        tablesReady = true;
+    }
+    return useHardware;
+}
+
+uint32 Compute(const void * const data,
+               const uint32 size) {
+    uint32 crc = 0xFFFFFFFFu;
+    const uint8 *bytes = reinterpret_cast<const uint8*>(data);
+#if defined(__x86_64__)
+    if (useHardware) {
+        crc = ComputeHardware(crc, bytes, size);
+    }
+    else {
+        crc = ComputeSoftware(crc, bytes, size);
+    }
+#else
+    crc = ComputeSoftware(crc, bytes, size);
+#endif
+    return (crc ^ 0xFFFFFFFFu);
+}
+
+}
+
+}
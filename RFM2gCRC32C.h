@@ -0,0 +1,77 @@
+/**
+ * @file RFM2gCRC32C.h
+ * @brief Header file for the RFM2gCRC32C functions
+ * @date 08/03/2021
+ * @authors Davide Liuzza, Luca Boncagni,  Cristian Galperti
+ *
+ *
+ * @copyright Copyright 2021 FSN-ENEA | Nuclear and Fusion Energy Department, ENEA Frascati (Rome)
+ * Italy.
+ * @copyright Copyright 2019 SPC | Swiss Plasma Center, EPFL Lausanne
+ * Switzerland.
+ * @copyright Copyright 2015 F4E | European Joint Undertaking for ITER and
+ * the Development of Fusion Energy ('Fusion for Energy').
+ * Licensed under the EUPL, Version 1.1 or - as soon they will be approved
+ * by the European Commission - subsequent versions of the EUPL (the "Licence")
+ * You may not use this work except in compliance with the Licence.
+ * You may obtain a copy of the Licence at: http://ec.europa.eu/idabc/eupl
+ *
+ * @warning Unless required by applicable law or agreed to in writing, 
+ * software distributed under the Licence is distributed on an "AS IS"
+ * basis, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+ * or implied. See the Licence permissions and limitations under the Licence.
+
+ * @details This header file contains the declaration of the CRC32C (Castagnoli)
+ * functions used by the RFM2g DataSource to check the integrity of the host segments.
+ */
+
+#ifndef RFM2G_CRC32C_H_
+#define RFM2G_CRC32C_H_
+
+/*---------------------------------------------------------------------------*/
+/*                        Standard header includes                           */
+/*---------------------------------------------------------------------------*/
+
+/*---------------------------------------------------------------------------*/
+/*                        Project header includes                            */
+/*---------------------------------------------------------------------------*/
+#include "CompilerTypes.h"
+
+/*---------------------------------------------------------------------------*/
+/*                           Class declaration                               */
+/*---------------------------------------------------------------------------*/
+namespace MARTe {
+
+/**
+ * @brief CRC32C (Castagnoli polynomial 0x1EDC6F41) of a memory segment.
+ * @details The SSE4.2 crc32 instruction is used when the CPU supports it,
+ * otherwise a slicing-by-8 table implementation. The choice is done once in Initialise.
+ */
+namespace RFM2gCRC32C {
+
+/**
+ * @brief Builds the slicing-by-8 tables and selects the SSE4.2 implementation if available.
+ * @details Not thread safe, must be called (at least once) before Compute, outside the real-time phase.
+ * @return true if the hardware (SSE4.2) implementation has been selected.
+ */
+bool Initialise();
+
+/**
+ * @brief Computes the CRC32C of size bytes starting at data.
+ * @param[in] data the memory to be checked.
+ * @param[in] size the number of bytes.
+ * @return the CRC32C value.
+ */
+uint32 Compute(const void * const data,
+               const uint32 size);
+
+}
+
+}
+
+/*---------------------------------------------------------------------------*/
+/*                        Inline method definitions                          */
+/*---------------------------------------------------------------------------*/
+
+#endif /* RFM2G_CRC32C_H_ */
+
@@ -0,0 +1,127 @@
+/**
+ * @file RFM2gFaultInjector.cpp
+ * @brief Source file for class RFM2gFaultInjector
+ * @date 08/03/2021
+ * @authors Davide Liuzza, Luca Boncagni,  Cristian Galperti
+ *
+ *
+ * @copyright Copyright 2021 FSN-ENEA | Nuclear and Fusion Energy Department, ENEA Frascati (Rome)
+ * Italy.
+ * @copyright Copyright 2019 SPC | Swiss Plasma Center, EPFL Lausanne
+ * Switzerland.
+ * @copyright Copyright 2015 F4E | European Joint Undertaking for ITER and
+ * the Development of Fusion Energy ('Fusion for Energy').
+ * Licensed under the EUPL, Version 1.1 or - as soon they will be approved
+ * by the European Commission - subsequent versions of the EUPL (the "Licence")
+ * You may not use this work except in compliance with the Licence.
+ * You may obtain a copy of the Licence at: http://ec.europa.eu/idabc/eupl
+ *
+ * @warning Unless required by applicable law or agreed to in writing,
+ * software distributed under the Licence is distributed on an "AS IS"
+ * basis, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+ * or implied. See the Licence permissions and limitations under the Licence.
+
+ * @details This source file contains the definition of all the methods for
+ * the class RFM2gFaultInjector (public, protected, and private). Be aware that some
+ * methods, such as those inline could be defined on the header file, instead.
+ */
+
+#define DLL_API
+
+/*---------------------------------------------------------------------------*/
+/*                         Standard header includes                          */
+/*---------------------------------------------------------------------------*/
+
+/*---------------------------------------------------------------------------*/
+/*                         Project header includes                           */
+/*---------------------------------------------------------------------------*/
+#include "RFM2gFaultInjector.h"
+#include "AdvancedErrorManagement.h"
+
+/*---------------------------------------------------------------------------*/
+/*                           Static definitions                              */
+/*---------------------------------------------------------------------------*/
+namespace MARTe {
+
+static const char8 * const faultNames[RFM2G_FAULTS] = { "WriteLatency", "DropWrite", "StaleCounter", "CorruptCounter", "FreezeMaster", "DMADelay",
+        "Jitter" };
+
+}
+
+/*---------------------------------------------------------------------------*/
+/*                           Method definitions                              */
+/*---------------------------------------------------------------------------*/
+namespace MARTe {
+
+RFM2gFaultInjector::RFM2gFaultInjector() {
+    uint32 f;
+    for (f = 0u; f < RFM2G_FAULTS; f++) {
+        schedules[f].enabled = false;
+        schedules[f].start = 0u;
+        schedules[f].period = 0u;
+        schedules[f].cycles = 1u;
+        schedules[f].latencyTicks = 0u;
+        schedules[f].injected = 0u;
+        active[f] = false;
+    }
+    enabled = false;
+}
+
+bool RFM2gFaultInjector::Initialise(StructuredDataI &faults,
+                                    const uint32 nodeIdNumber) {
+    bool ok = true;
+    uint32 f;
+    for (f = 0u; (f < RFM2G_FAULTS) && ok; f++) {
+        if (faults.MoveRelative(faultNames[f])) {
+            RFM2gFaultSchedule &schedule = schedules[f];
+
+            //without a Host the fault applies on every node
+            uint32 host = nodeIdNumber;
+            (void) faults.Read("Host", host);
+            schedule.enabled = (host == nodeIdNumber);
+
+            (void) faults.Read("Start", schedule.start);
+            (void) faults.Read("Period", schedule.period);
+            (void) faults.Read("Cycles", schedule.cycles);
+            if (schedule.cycles == 0u) {
+                REPORT_ERROR(ErrorManagement::InitialisationError, "Faults.%s: Cycles must be at least 1", faultNames[f]);
+                ok = false;
+            }
+
+            //the latency (us) of the faults that wait
+            bool waits = (f == RFM2G_FAULT_WRITE_LATENCY) || (f == RFM2G_FAULT_DMA_DELAY) || (f == RFM2G_FAULT_JITTER);
+            if (ok && waits) {
+                float64 latency = 0.0;
+                if (!faults.Read("Latency", latency) || (latency <= 0.0)) {
+                    REPORT_ERROR(ErrorManagement::InitialisationError, "Faults.%s: Latency (us) must be given and positive", faultNames[f]);
+                    ok = false;
+                }
+                else {
+                    schedule.latencyTicks = static_cast<uint64>(latency * 1e-6 * static_cast<float64>(HighResolutionTimer::Frequency()));
+                }
+            }
+
+            if (ok && schedule.enabled) {
+                enabled = true;
+                REPORT_ERROR(ErrorManagement::Warning, "Fault %s injected for %d cycles from cycle %d every %d cycles (0: once)", faultNames[f],
+                             schedule.cycles, schedule.start, schedule.period);
+            }
+
+            if (!faults.MoveToAncestor(1u)) {
+                ok = false;
+            }
+        }
+    }
+
+    return ok;
+}
+
+uint32 RFM2gFaultInjector::GetInjected(const uint32 fault) const {
+    return schedules[fault].injected;
+}
+
+const char8 *RFM2gFaultInjector::GetName(const uint32 fault) {
+    return faultNames[fault];
+}
+
+}
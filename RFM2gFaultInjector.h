@@ -0,0 +1,189 @@
+/**
+ * @file RFM2gFaultInjector.h
+ * @brief Header file for class RFM2gFaultInjector
+ * @date 08/03/2021
+ * @authors Davide Liuzza, Luca Boncagni,  Cristian Galperti
+ *
+ *
+ * @copyright Copyright 2021 FSN-ENEA | Nuclear and Fusion Energy Department, ENEA Frascati (Rome)
+ * Italy.
+ * @copyright Copyright 2019 SPC | Swiss Plasma Center, EPFL Lausanne
+ * Switzerland.
+ * @copyright Copyright 2015 F4E | European Joint Undertaking for ITER and
+ * the Development of Fusion Energy ('Fusion for Energy').
+ * Licensed under the EUPL, Version 1.1 or - as soon they will be approved
+ * by the European Commission - subsequent versions of the EUPL (the "Licence")
+ * You may not use this work except in compliance with the Licence.
+ * You may obtain a copy of the Licence at: http://ec.europa.eu/idabc/eupl
+ *
+ * @warning Unless required by applicable law or agreed to in writing,
+ * software distributed under the Licence is distributed on an "AS IS"
+ * basis, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+ * or implied. See the Licence permissions and limitations under the Licence.
+
+ * @details This header file contains the declaration of the class RFM2gFaultInjector
+ * used by the RFM2g DataSource to inject jitter, dropped writes and stalled hosts on configured cycles.
+ */
+
+#ifndef RFM2G_FAULT_INJECTOR_H_
+#define RFM2G_FAULT_INJECTOR_H_
+
+/*---------------------------------------------------------------------------*/
+/*                        Standard header includes                           */
+/*---------------------------------------------------------------------------*/
+
+/*---------------------------------------------------------------------------*/
+/*                        Project header includes                            */
+/*---------------------------------------------------------------------------*/
+#include "CompilerTypes.h"
+#include "HighResolutionTimer.h"
+#include "StructuredDataI.h"
+
+/*---------------------------------------------------------------------------*/
+/*                           Class declaration                               */
+/*---------------------------------------------------------------------------*/
+namespace MARTe {
+
+/**
+ * The faults, each configured by the block of the same name in Faults
+ */
+const uint32 RFM2G_FAULT_WRITE_LATENCY = 0u;   //WriteLatency: busy wait before the write of this host
+const uint32 RFM2G_FAULT_DROP_WRITE = 1u;      //DropWrite: the write of this host is skipped
+const uint32 RFM2G_FAULT_STALE_COUNTER = 2u;   //StaleCounter: the payload is written with the previous counter stamp
+const uint32 RFM2G_FAULT_CORRUPT_COUNTER = 3u; //CorruptCounter: the counter stamp is corrupted after the CRC
+const uint32 RFM2G_FAULT_FREEZE_MASTER = 4u;   //FreezeMaster: the master does not step the ring counter
+const uint32 RFM2G_FAULT_DMA_DELAY = 5u;       //DMADelay: busy wait after each DMA transfer
+const uint32 RFM2G_FAULT_JITTER = 6u;          //Jitter: busy wait in Synchronise
+const uint32 RFM2G_FAULTS = 7u;
+
+/**
+ * The schedule of a fault: Cycles cycles from Start, repeated every Period cycles (once if Period=0)
+ */
+struct RFM2gFaultSchedule {
+    bool enabled;
+    uint32 start;
+    uint32 period;
+    uint32 cycles;
+    uint64 latencyTicks;
+    uint32 injected;
+};
+
+/**
+ * @brief Fault injection on the RFM2g data path.
+ * @details The faults are configured per cycle of the node (its Counter). BeginCycle() evaluates once the schedules,
+ * so that in the cycle Active() is a table lookup; Delay() busy waits the configured latency, as the card would.
+ * A fault with a Host only applies on the node with that NodeIdNumber, so that all the nodes can share the same Faults block.
+ */
+class RFM2gFaultInjector {
+public:
+
+    /**
+     * @brief Constructor. No fault.
+     */
+    RFM2gFaultInjector();
+
+    /**
+     * @brief Reads the faults from the current node (the Faults block) for the node nodeIdNumber.
+     */
+    bool Initialise(StructuredDataI &faults,
+                    const uint32 nodeIdNumber);
+
+    /**
+     * @brief True if at least one fault is configured for this node.
+     */
+    inline bool IsEnabled() const;
+
+    /**
+     * @brief True if the fault is configured for this node.
+     */
+    inline bool IsConfigured(const uint32 fault) const;
+
+    /**
+     * @brief Evaluates the schedules for the cycle.
+     */
+    inline void BeginCycle(const uint32 cycle);
+
+    /**
+     * @brief True if the fault is scheduled in the current cycle.
+     */
+    inline bool Active(const uint32 fault) const;
+
+    /**
+     * @brief Busy waits the latency of the fault if it is scheduled in the current cycle.
+     */
+    inline void Delay(const uint32 fault) const;
+
+    /**
+     * @brief The cycles in which the fault has been injected.
+     */
+    uint32 GetInjected(const uint32 fault) const;
+
+    /**
+     * @brief The configuration name of the fault.
+     */
+    static const char8 *GetName(const uint32 fault);
+
+private:
+
+    /**
+     * The schedules and the faults of the current cycle
+     */
+    RFM2gFaultSchedule schedules[RFM2G_FAULTS];
+    bool active[RFM2G_FAULTS];
+
+    /**
+     * At least one fault configured
+     */
+    bool enabled;
+};
+
+}
+
+/*---------------------------------------------------------------------------*/
+/*                        Inline method definitions                          */
+/*---------------------------------------------------------------------------*/
+namespace MARTe {
+
+bool RFM2gFaultInjector::IsEnabled() const {
+    return enabled;
+}
+
+bool RFM2gFaultInjector::IsConfigured(const uint32 fault) const {
+    return schedules[fault].enabled;
+}
+
+void RFM2gFaultInjector::BeginCycle(const uint32 cycle) {
+    uint32 f;
+    for (f = 0u; f < RFM2G_FAULTS; f++) {
+        RFM2gFaultSchedule &schedule = schedules[f];
+        bool scheduled = schedule.enabled && (cycle >= schedule.start);
+        if (scheduled) {
+            uint32 elapsed = cycle - schedule.start;
+            if (schedule.period > 0u) {
+                elapsed = elapsed % schedule.period;
+            }
+            scheduled = (elapsed < schedule.cycles);
+        }
+        if (scheduled) {
+            schedule.injected++;
+        }
+        active[f] = scheduled;
+    }
+}
+
+bool RFM2gFaultInjector::Active(const uint32 fault) const {
+    return active[fault];
+}
+
+void RFM2gFaultInjector::Delay(const uint32 fault) const {
+    if (active[fault]) {
+        uint64 startTicks = HighResolutionTimer::Counter();
+        while ((HighResolutionTimer::Counter() - startTicks) < schedules[fault].latencyTicks) {
+            ;
+        }
+    }
+}
+
+}
+
+#endif /* RFM2G_FAULT_INJECTOR_H_ */
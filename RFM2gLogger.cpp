@@ -0,0 +1,278 @@
+/**
+ * @file RFM2gLogger.cpp
+ * @brief Source file for class RFM2gLogger
+ * @date 08/03/2021
+ * @authors Davide Liuzza, Luca Boncagni,  Cristian Galperti
+ *
+ *
+ * @copyright Copyright 2021 FSN-ENEA | Nuclear and Fusion Energy Department, ENEA Frascati (Rome)
+ * Italy.
+ * @copyright Copyright 2019 SPC | Swiss Plasma Center, EPFL Lausanne
+ * Switzerland.
+ * @copyright Copyright 2015 F4E | European Joint Undertaking for ITER and
+ * the Development of Fusion Energy ('Fusion for Energy').
+ * Licensed under the EUPL, Version 1.1 or - as soon they will be approved
+ * by the European Commission - subsequent versions of the EUPL (the "Licence")
+ * You may not use this work except in compliance with the Licence.
+ * You may obtain a copy of the Licence at: http://ec.europa.eu/idabc/eupl
+ *
+ * @warning Unless required by applicable law or agreed to in writing, 
+ * software distributed under the Licence is distributed on an "AS IS"
+ * basis, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+ * or implied. See the Licence permissions and limitations under the Licence.
+
+ * @details This source file contains the definition of all the methods for
+ * the class RFM2gLogger (public, protected, and private). Be aware that some
+ * methods, such as those inline could be defined on the header file, instead.
+ */
+
+#define DLL_API
+
+/*---------------------------------------------------------------------------*/
+/*                         Standard header includes                          */
+/*---------------------------------------------------------------------------*/
+#include <sched.h>
+#include <unistd.h>
+
+/*---------------------------------------------------------------------------*/
+/*                         Project header includes                           */
+/*---------------------------------------------------------------------------*/
+#include "RFM2gLogger.h"
+#include "AdvancedErrorManagement.h"
+#include "HighResolutionTimer.h"
+
+/*---------------------------------------------------------------------------*/
+/*                           Static definitions                              */
+/*---------------------------------------------------------------------------*/
+
+/*---------------------------------------------------------------------------*/
+/*                           Method definitions                              */
+/*---------------------------------------------------------------------------*/
+namespace MARTe {
+
+RFM2gLogger::RFM2gLogger() {
+    messages = static_cast<RFM2gLogMessage*>(NULL);
+    numberOfMessages = 0u;
+    cells = static_cast<Cell*>(NULL);
+    mask = 0u;
+    enqueuePosition = 0u;
+    dequeuePosition = 0u;
+    dropped = 0u;
+    emitterStarted = false;
+    emitting = false;
+    emitHook = static_cast<RFM2gEmitHook>(NULL);
+    emitHookArgument = NULL;
+}
+
+RFM2gLogger::~RFM2gLogger() {
+    Stop();
+    if (messages != NULL) {
+        delete[] messages;
+    }
+    if (cells != NULL) {
+        delete[] cells;
+    }
+}
+
+bool RFM2gLogger::Initialise(const uint32 numberOfMessages,
+                             const uint32 queueSize) {
+
+    uint32 size = 2u;
+    while (size < queueSize) {
+        size = size * 2u;
+    }
+
+    this->numberOfMessages = numberOfMessages;
+    messages = new RFM2gLogMessage[numberOfMessages];
+    cells = new Cell[size];
+
+    bool ok = (messages != NULL) && (cells != NULL) && (!emitterStarted);
+
+    if (ok) {
+        uint32 i = 0u;
+        for (i = 0u; i < numberOfMessages; i++) {
+            messages[i].type = ErrorManagement::Information;
+            messages[i].format = "";
+            messages[i].numberOfArguments = 0u;
+            messages[i].minIntervalTicks = 0u;
+            messages[i].lastTicks = 0u;
+            messages[i].suppressed = 0u;
+        }
+        for (i = 0u; i < size; i++) {
+            cells[i].sequence = i;
+        }
+        mask = size - 1u;
+    }
+
+    return ok;
+}
+
+bool RFM2gLogger::SetMessage(const uint32 messageId,
+                             const ErrorManagement::ErrorIntegerFormat type,
+                             const char8 * const format,
+                             const uint32 numberOfArguments,
+                             const float64 minInterval) {
+
+    bool ok = (messageId < numberOfMessages) && (numberOfArguments <= RFM2G_LOG_MAX_ARGUMENTS);
+
+    if (ok) {
+        messages[messageId].type = type;
+        messages[messageId].format = format;
+        messages[messageId].numberOfArguments = numberOfArguments;
+        messages[messageId].minIntervalTicks = static_cast<uint64>(minInterval * static_cast<float64>(HighResolutionTimer::Frequency()));
+    }
+
+    return ok;
+}
+
+void RFM2gLogger::SetEmitHook(const RFM2gEmitHook hook,
+                              void * const argument) {
+    emitHook = hook;
+    emitHookArgument = argument;
+}
+
+void RFM2gLogger::Stop() {
+    if (emitterStarted) {
+        emitting = false;
+        (void) pthread_join(emitter, NULL);
+        emitterStarted = false;
+        if (cells != NULL) {
+            Emit();
+        }
+    }
+}
+
+bool RFM2gLogger::Start() {
+    bool ok = (cells != NULL) && (!emitterStarted);
+    if (ok) {
+        emitting = true;
+        ok = (pthread_create(&emitter, NULL, &RFM2gLogger::EmitterThread, this) == 0);
+        emitterStarted = ok;
+    }
+    return ok;
+}
+
+bool RFM2gLogger::Log(const uint32 messageId,
+                      const int32 argument0,
+                      const int32 argument1,
+                      const int32 argument2,
+                      const float64 value) {
+
+    bool ok = (messageId < numberOfMessages) && (cells != NULL);
+
+    //rate limit: a record too close to the previous one is only counted
+    if (ok) {
+        RFM2gLogMessage &message = messages[messageId];
+        uint64 nowTicks = HighResolutionTimer::Counter();
+        ok = ((message.lastTicks == 0u) || ((nowTicks - message.lastTicks) >= message.minIntervalTicks));
+        if (ok) {
+            message.lastTicks = nowTicks;
+        }
+        else {
+            (void) __sync_fetch_and_add(&message.suppressed, 1u);
+        }
+    }
+
+    //bounded queue with a sequence number per cell, the producers reserve a cell with a compare and swap
+    Cell *cell = static_cast<Cell*>(NULL);
+    uint32 position = enqueuePosition;
+    while (ok && (cell == NULL)) {
+        Cell *candidate = &cells[position & mask];
+        int32 difference = static_cast<int32>(candidate->sequence - position);
+        if (difference == 0) {
+            if (__sync_bool_compare_and_swap(&enqueuePosition, position, position + 1u)) {
+                cell = candidate;
+            }
+            else {
+                position = enqueuePosition;
+            }
+        }
+        else if (difference < 0) {
+            //full: the real-time thread never waits for the emitter
+            (void) __sync_fetch_and_add(&dropped, 1u);
+            ok = false;
+        }
+        else {
+            position = enqueuePosition;
+        }
+    }
+
+    if (ok) {
+        cell->record.messageId = messageId;
+        cell->record.suppressed = __sync_lock_test_and_set(&messages[messageId].suppressed, 0u);
+        cell->record.arguments[0] = argument0;
+        cell->record.arguments[1] = argument1;
+        cell->record.arguments[2] = argument2;
+        cell->record.value = value;
+        __sync_synchronize();
+        cell->sequence = position + 1u;
+    }
+
+    return ok;
+}
+
+uint32 RFM2gLogger::GetDropped() const {
+    return dropped;
+}
+
+void *RFM2gLogger::EmitterThread(void *logger) {
+    RFM2gLogger *log = static_cast<RFM2gLogger*>(logger);
+
+    //the emitter must never preempt the real-time threads
+    struct sched_param param;
+    param.sched_priority = 0;
+    (void) pthread_setschedparam(pthread_self(), SCHED_OTHER, &param);
+    (void) nice(10);
+
+    while (log->emitting) {
+        log->Emit();
+        if (log->emitHook != NULL) {
+            log->emitHook(log->emitHookArgument);
+        }
+        (void) usleep(10000u);
+    }
+
+    return NULL;
+}
+
+void RFM2gLogger::Emit() {
+    bool empty = false;
+
+    while (!empty) {
+        Cell &cell = cells[dequeuePosition & mask];
+        empty = (cell.sequence != (dequeuePosition + 1u));
+        if (!empty) {
+            __sync_synchronize();
+            RFM2gLogRecord record = cell.record;
+            __sync_synchronize();
+            cell.sequence = dequeuePosition + mask + 1u;
+            dequeuePosition++;
+            Report(record);
+        }
+    }
+}
+
+void RFM2gLogger::Report(const RFM2gLogRecord &record) const {
+    const RFM2gLogMessage &message = messages[record.messageId];
+    ErrorManagement::ErrorType type = message.type;
+    const int32 *a = &record.arguments[0];
+
+    if (message.numberOfArguments == 0u) {
+        REPORT_ERROR(type, message.format, record.value);
+    }
+    else if (message.numberOfArguments == 1u) {
+        REPORT_ERROR(type, message.format, a[0], record.value);
+    }
+    else if (message.numberOfArguments == 2u) {
+        REPORT_ERROR(type, message.format, a[0], a[1], record.value);
+    }
+    else {
+        REPORT_ERROR(type, message.format, a[0], a[1], a[2], record.value);
+    }
+
+    if (record.suppressed > 0u) {
+        REPORT_ERROR(type, "(%d similar messages suppressed)", record.suppressed);
+    }
+}
+
+}
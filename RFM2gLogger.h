@@ -0,0 +1,209 @@
+/**
+ * @file RFM2gLogger.h
+ * @brief Header file for class RFM2gLogger
+ * @date 08/03/2021
+ * @authors Davide Liuzza, Luca Boncagni,  Cristian Galperti
+ *
+ *
+ * @copyright Copyright 2021 FSN-ENEA | Nuclear and Fusion Energy Department, ENEA Frascati (Rome)
+ * Italy.
+ * @copyright Copyright 2019 SPC | Swiss Plasma Center, EPFL Lausanne
+ * Switzerland.
+ * @copyright Copyright 2015 F4E | European Joint Undertaking for ITER and
+ * the Development of Fusion Energy ('Fusion for Energy').
+ * Licensed under the EUPL, Version 1.1 or - as soon they will be approved
+ * by the European Commission - subsequent versions of the EUPL (the "Licence")
+ * You may not use this work except in compliance with the Licence.
+ * You may obtain a copy of the Licence at: http://ec.europa.eu/idabc/eupl
+ *
+ * @warning Unless required by applicable law or agreed to in writing, 
+ * software distributed under the Licence is distributed on an "AS IS"
+ * basis, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+ * or implied. See the Licence permissions and limitations under the Licence.
+
+ * @details This header file contains the declaration of the class RFM2gLogger
+ * used by the RFM2g DataSource to report from the real-time cycle without formatting nor locking in it.
+ */
+
+#ifndef RFM2G_LOGGER_H_
+#define RFM2G_LOGGER_H_
+
+/*---------------------------------------------------------------------------*/
+/*                        Standard header includes                           */
+/*---------------------------------------------------------------------------*/
+#include <pthread.h>
+
+/*---------------------------------------------------------------------------*/
+/*                        Project header includes                            */
+/*---------------------------------------------------------------------------*/
+#include "CompilerTypes.h"
+#include "ErrorType.h"
+
+/*---------------------------------------------------------------------------*/
+/*                           Class declaration                               */
+/*---------------------------------------------------------------------------*/
+namespace MARTe {
+
+/**
+ * The integer arguments of a record
+ */
+const uint32 RFM2G_LOG_MAX_ARGUMENTS = 3u;
+
+/**
+ * A fixed size binary log record: the message, its arguments and the messages suppressed before it
+ */
+struct RFM2gLogRecord {
+    uint32 messageId;
+    uint32 suppressed;
+    int32 arguments[RFM2G_LOG_MAX_ARGUMENTS];
+    float64 value;
+};
+
+/**
+ * A registered message: the REPORT_ERROR type and format, the integer arguments used by the format
+ * (the float value, if any, follows them) and the rate limit
+ */
+struct RFM2gLogMessage {
+    ErrorManagement::ErrorIntegerFormat type;
+    const char8 *format;
+    uint32 numberOfArguments;
+    uint64 minIntervalTicks;
+    volatile uint64 lastTicks;
+    volatile uint32 suppressed;
+};
+
+/**
+ * A function called by the emitter thread after each pass, e.g. to send the messages requested by the real-time cycle
+ */
+typedef void (*RFM2gEmitHook)(void *argument);
+
+/**
+ * @brief Deferred logging for the real-time cycle.
+ * @details Log() only fills a fixed size record in a bounded lock-free queue (several producers, one consumer) and never
+ * formats, allocates nor blocks. Each message is rate limited: the records closer than its minimum interval are only
+ * counted and the count is reported with the next record. A low priority thread formats the records with REPORT_ERROR.
+ */
+class RFM2gLogger {
+public:
+
+    /**
+     * @brief Constructor. No message and no queue.
+     */
+    RFM2gLogger();
+
+    /**
+     * @brief Stops the thread, emitting the queued records.
+     */
+    ~RFM2gLogger();
+
+    /**
+     * @brief Allocates the table of numberOfMessages messages and a queue of queueSize records (rounded up to a power of 2).
+     */
+    bool Initialise(const uint32 numberOfMessages,
+                    const uint32 queueSize);
+
+    /**
+     * @brief Registers the message messageId, at most one record every minInterval seconds.
+     */
+    bool SetMessage(const uint32 messageId,
+                    const ErrorManagement::ErrorIntegerFormat type,
+                    const char8 * const format,
+                    const uint32 numberOfArguments,
+                    const float64 minInterval);
+
+    /**
+     * @brief Sets the function called by the emitter thread after each pass. Before Start().
+     */
+    void SetEmitHook(const RFM2gEmitHook hook,
+                     void * const argument);
+
+    /**
+     * @brief Starts the thread emitting the records.
+     */
+    bool Start();
+
+    /**
+     * @brief Stops the thread, emitting the queued records. The hook is not called anymore.
+     */
+    void Stop();
+
+    /**
+     * @brief Queues a record. Real-time safe.
+     * @return false if the record was rate limited or the queue was full.
+     */
+    bool Log(const uint32 messageId,
+             const int32 argument0 = 0,
+             const int32 argument1 = 0,
+             const int32 argument2 = 0,
+             const float64 value = 0.0);
+
+    /**
+     * @brief The records lost because the queue was full.
+     */
+    uint32 GetDropped() const;
+
+private:
+
+    /**
+     * @brief The thread body.
+     */
+    static void *EmitterThread(void *logger);
+
+    /**
+     * @brief Emits all the queued records.
+     */
+    void Emit();
+
+    /**
+     * @brief Formats a record with REPORT_ERROR.
+     */
+    void Report(const RFM2gLogRecord &record) const;
+
+    /**
+     * A queue cell: the record and its sequence number
+     */
+    struct Cell {
+        volatile uint32 sequence;
+        RFM2gLogRecord record;
+    };
+
+    /**
+     * The registered messages
+     */
+    RFM2gLogMessage *messages;
+    uint32 numberOfMessages;
+
+    /**
+     * The queue, its mask (size - 1) and the positions of the producers and of the consumer
+     */
+    Cell *cells;
+    uint32 mask;
+    volatile uint32 enqueuePosition;
+    uint32 dequeuePosition;
+
+    /**
+     * Records lost because the queue was full
+     */
+    volatile uint32 dropped;
+
+    /**
+     * The emitter thread and its run flag
+     */
+    pthread_t emitter;
+    bool emitterStarted;
+    volatile bool emitting;
+
+    /**
+     * The function called after each pass and its argument
+     */
+    RFM2gEmitHook emitHook;
+    void *emitHookArgument;
+};
+
+}
+
+/*---------------------------------------------------------------------------*/
+/*                        Inline method definitions                          */
+/*---------------------------------------------------------------------------*/
+
+#endif /* RFM2G_LOGGER_H_ */
@@ -0,0 +1,69 @@
+/**
+ * @file RFM2gMailbox.h
+ * @brief Header file for the RFM2g mailboxes
+ * @date 08/03/2021
+ * @authors Davide Liuzza, Luca Boncagni,  Cristian Galperti
+ *
+ *
+ * @copyright Copyright 2021 FSN-ENEA | Nuclear and Fusion Energy Department, ENEA Frascati (Rome)
+ * Italy.
+ * @copyright Copyright 2019 SPC | Swiss Plasma Center, EPFL Lausanne
+ * Switzerland.
+ * @copyright Copyright 2015 F4E | European Joint Undertaking for ITER and
+ * the Development of Fusion Energy ('Fusion for Energy').
+ * Licensed under the EUPL, Version 1.1 or - as soon they will be approved
+ * by the European Commission - subsequent versions of the EUPL (the "Licence")
+ * You may not use this work except in compliance with the Licence.
+ * You may obtain a copy of the Licence at: http://ec.europa.eu/idabc/eupl
+ *
+ * @warning Unless required by applicable law or agreed to in writing,
+ * software distributed under the Licence is distributed on an "AS IS"
+ * basis, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+ * or implied. See the Licence permissions and limitations under the Licence.
+
+ * @details This header file contains the layout of the mailboxes that the RFM2g DataSource places in the RFM memory
+ * to pass discrete messages between pairs of nodes.
+ */
+
+#ifndef RFM2G_MAILBOX_H_
+#define RFM2G_MAILBOX_H_
+
+/*---------------------------------------------------------------------------*/
+/*                        Standard header includes                           */
+/*---------------------------------------------------------------------------*/
+
+/*---------------------------------------------------------------------------*/
+/*                        Project header includes                            */
+/*---------------------------------------------------------------------------*/
+#include "CompilerTypes.h"
+
+/*---------------------------------------------------------------------------*/
+/*                           Class declaration                               */
+/*---------------------------------------------------------------------------*/
+namespace MARTe {
+
+/**
+ * @brief The header of the mailbox from a node to another, followed by its slots.
+ * @details head is written only by the sender and tail only by the receiver, both count the messages since the start:
+ * the mailbox is empty when they are equal and full when head - tail is the number of slots. A slot is the size of
+ * the message followed by the message.
+ */
+struct RFM2gMailboxHeader {
+    uint32 head;
+    uint32 tail;
+};
+
+/**
+ * The offsets of the header words and of the size word in a slot
+ */
+const uint32 RFM2G_MAILBOX_HEAD_OFFSET = 0u;
+const uint32 RFM2G_MAILBOX_TAIL_OFFSET = 4u;
+const uint32 RFM2G_MAILBOX_SIZE_OFFSET = 0u;
+
+}
+
+/*---------------------------------------------------------------------------*/
+/*                        Inline method definitions                          */
+/*---------------------------------------------------------------------------*/
+
+#endif /* RFM2G_MAILBOX_H_ */
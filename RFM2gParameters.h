@@ -0,0 +1,72 @@
+/**
+ * @file RFM2gParameters.h
+ * @brief Header file for the RFM2g parameter broadcast
+ * @date 08/03/2021
+ * @authors Davide Liuzza, Luca Boncagni,  Cristian Galperti
+ *
+ *
+ * @copyright Copyright 2021 FSN-ENEA | Nuclear and Fusion Energy Department, ENEA Frascati (Rome)
+ * Italy.
+ * @copyright Copyright 2019 SPC | Swiss Plasma Center, EPFL Lausanne
+ * Switzerland.
+ * @copyright Copyright 2015 F4E | European Joint Undertaking for ITER and
+ * the Development of Fusion Energy ('Fusion for Energy').
+ * Licensed under the EUPL, Version 1.1 or - as soon they will be approved
+ * by the European Commission - subsequent versions of the EUPL (the "Licence")
+ * You may not use this work except in compliance with the Licence.
+ * You may obtain a copy of the Licence at: http://ec.europa.eu/idabc/eupl
+ *
+ * @warning Unless required by applicable law or agreed to in writing,
+ * software distributed under the Licence is distributed on an "AS IS"
+ * basis, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+ * or implied. See the Licence permissions and limitations under the Licence.
+
+ * @details This header file contains the layout of the parameter block that the RFM2g DataSource master publishes
+ * in the RFM memory and that all the nodes apply on the same master cycle.
+ */
+
+#ifndef RFM2G_PARAMETERS_H_
+#define RFM2G_PARAMETERS_H_
+
+/*---------------------------------------------------------------------------*/
+/*                        Standard header includes                           */
+/*---------------------------------------------------------------------------*/
+
+/*---------------------------------------------------------------------------*/
+/*                        Project header includes                            */
+/*---------------------------------------------------------------------------*/
+#include "CompilerTypes.h"
+
+/*---------------------------------------------------------------------------*/
+/*                           Class declaration                               */
+/*---------------------------------------------------------------------------*/
+namespace MARTe {
+
+/**
+ * @brief The header of the parameter region, followed by the block.
+ * @details The master writes version 0 first, then the header and the block, then the new version: a reader only takes
+ * the block if it reads the same non zero version before and after it. applyCycle is the master cycle (ring counter)
+ * from which the block is in force.
+ */
+struct RFM2gParameterHeader {
+    uint32 version;
+    int32 applyCycle;
+    uint32 size;
+    uint32 crc; //CRC32C of the block
+};
+
+/**
+ * The offsets of the header words in the parameter region
+ */
+const uint32 RFM2G_PARAMETER_VERSION_OFFSET = 0u;
+const uint32 RFM2G_PARAMETER_APPLY_CYCLE_OFFSET = 4u;
+const uint32 RFM2G_PARAMETER_SIZE_OFFSET = 8u;
+const uint32 RFM2G_PARAMETER_CRC_OFFSET = 12u;
+
+}
+
+/*---------------------------------------------------------------------------*/
+/*                        Inline method definitions                          */
+/*---------------------------------------------------------------------------*/
+
+#endif /* RFM2G_PARAMETERS_H_ */
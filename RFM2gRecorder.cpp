@@ -0,0 +1,234 @@
+/**
+ * @file RFM2gRecorder.cpp
+ * @brief Source file for class RFM2gRecorder
+ * @date 08/03/2021
+ * @authors Davide Liuzza, Luca Boncagni,  Cristian Galperti
+ *
+ *
+ * @copyright Copyright 2021 FSN-ENEA | Nuclear and Fusion Energy Department, ENEA Frascati (Rome)
+ * Italy.
+ * @copyright Copyright 2019 SPC | Swiss Plasma Center, EPFL Lausanne
+ * Switzerland.
+ * @copyright Copyright 2015 F4E | European Joint Undertaking for ITER and
+ * the Development of Fusion Energy ('Fusion for Energy').
+ * Licensed under the EUPL, Version 1.1 or - as soon they will be approved
+ * by the European Commission - subsequent versions of the EUPL (the "Licence")
+ * You may not use this work except in compliance with the Licence.
+ * You may obtain a copy of the Licence at: http://ec.europa.eu/idabc/eupl
+ *
+ * @warning Unless required by applicable law or agreed to in writing, 
+ * software distributed under the Licence is distributed on an "AS IS"
+ * basis, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+ * or implied. See the Licence permissions and limitations under the Licence.
+
+ * @details This source file contains the definition of all the methods for
+ * the class RFM2gRecorder (public, protected, and private). Be aware that some
+ * methods, such as those inline could be defined on the header file, instead.
+ */
+
+#define DLL_API
+
+/*---------------------------------------------------------------------------*/
+/*                         Standard header includes                          */
+/*---------------------------------------------------------------------------*/
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+/*---------------------------------------------------------------------------*/
+/*                         Project header includes                           */
+/*---------------------------------------------------------------------------*/
+#include "RFM2gRecorder.h"
+
+/*---------------------------------------------------------------------------*/
+/*                           Static definitions                              */
+/*---------------------------------------------------------------------------*/
+
+/*---------------------------------------------------------------------------*/
+/*                           Method definitions                              */
+/*---------------------------------------------------------------------------*/
+namespace MARTe {
+
+RFM2gRecorder::RFM2gRecorder() {
+    file = static_cast<FILE*>(NULL);
+    ring = static_cast<uint8*>(NULL);
+    slotSize = 0u;
+    numberOfSlots = 0u;
+    head = 0u;
+    tail = 0u;
+    dropped = 0u;
+    writerStarted = false;
+    writing = false;
+}
+
+RFM2gRecorder::~RFM2gRecorder() {
+    if (writerStarted) {
+        writing = false;
+        (void) pthread_join(writer, NULL);
+        Drain();
+    }
+    if (file != NULL) {
+        (void) fclose(file);
+    }
+    if (ring != NULL) {
+        free(ring);
+    }
+}
+
+bool RFM2gRecorder::OpenRecord(const char8 * const fileName,
+                               const uint32 numberOfHosts,
+                               const uint32 trailerSize,
+                               const uint32 slotSize,
+                               const uint32 numberOfSlots) {
+
+    this->slotSize = slotSize;
+    this->numberOfSlots = numberOfSlots;
+
+    bool ok = (numberOfSlots > 1u) && (file == NULL);
+
+    if (ok) {
+        ring = static_cast<uint8*>(malloc(static_cast<size_t>(numberOfSlots) * (sizeof(RFM2gRecordFrame) + slotSize)));
+        ok = (ring != NULL);
+    }
+    if (ok) {
+        //the slots are touched here, not in the real-time phase
+        memset(ring, 0, static_cast<size_t>(numberOfSlots) * (sizeof(RFM2gRecordFrame) + slotSize));
+        file = fopen(fileName, "wb");
+        ok = (file != NULL);
+    }
+    if (ok) {
+        RFM2gRecordHeader header;
+        header.magic = RFM2G_RECORD_MAGIC;
+        header.version = RFM2G_RECORD_VERSION;
+        header.numberOfHosts = numberOfHosts;
+        header.trailerSize = trailerSize;
+        ok = (fwrite(&header, sizeof(header), 1u, file) == 1u);
+    }
+    if (ok) {
+        writing = true;
+        ok = (pthread_create(&writer, NULL, &RFM2gRecorder::WriterThread, this) == 0);
+        writerStarted = ok;
+    }
+
+    return ok;
+}
+
+bool RFM2gRecorder::Record(const uint32 type,
+                           const int32 counter,
+                           const int32 time,
+                           const uint64 timestampNs,
+                           const void * const payload,
+                           const uint32 size) {
+
+    uint32 next = (head + 1u) % numberOfSlots;
+
+    //full ring or oversized frame: the real-time thread never waits for the disk
+    bool ok = writerStarted && (next != tail) && (size <= slotSize);
+
+    if (ok) {
+        uint8 *slot = ring + static_cast<size_t>(head) * (sizeof(RFM2gRecordFrame) + slotSize);
+        RFM2gRecordFrame *frame = reinterpret_cast<RFM2gRecordFrame*>(slot);
+        frame->type = type;
+        frame->size = size;
+        frame->counter = counter;
+        frame->time = time;
+        frame->timestampNs = timestampNs;
+        memcpy(slot + sizeof(RFM2gRecordFrame), payload, size);
+
+        //the slot is complete before the writer can see it
+        __sync_synchronize();
+        head = next;
+    }
+    else if (writerStarted) {
+        dropped++;
+    }
+
+    return ok;
+}
+
+uint32 RFM2gRecorder::GetDropped() const {
+    return dropped;
+}
+
+void *RFM2gRecorder::WriterThread(void *recorder) {
+    RFM2gRecorder *rec = static_cast<RFM2gRecorder*>(recorder);
+
+    while (rec->writing) {
+        rec->Drain();
+        (void) usleep(1000u);
+    }
+
+    return NULL;
+}
+
+void RFM2gRecorder::Drain() {
+    bool written = false;
+
+    while (tail != head) {
+        __sync_synchronize();
+        const uint8 *slot = ring + static_cast<size_t>(tail) * (sizeof(RFM2gRecordFrame) + slotSize);
+        const RFM2gRecordFrame *frame = reinterpret_cast<const RFM2gRecordFrame*>(slot);
+        (void) fwrite(slot, sizeof(RFM2gRecordFrame) + frame->size, 1u, file);
+        __sync_synchronize();
+        tail = (tail + 1u) % numberOfSlots;
+        written = true;
+    }
+
+    if (written) {
+        (void) fflush(file);
+    }
+}
+
+bool RFM2gRecorder::OpenReplay(const char8 * const fileName,
+                               const uint32 numberOfHosts,
+                               const uint32 trailerSize) {
+
+    bool ok = (file == NULL);
+
+    if (ok) {
+        file = fopen(fileName, "rb");
+        ok = (file != NULL);
+    }
+
+    RFM2gRecordHeader header;
+    if (ok) {
+        ok = (fread(&header, sizeof(header), 1u, file) == 1u);
+    }
+    if (ok) {
+        ok = (header.magic == RFM2G_RECORD_MAGIC) && (header.version == RFM2G_RECORD_VERSION) && (header.numberOfHosts == numberOfHosts)
+                && (header.trailerSize == trailerSize);
+    }
+
+    return ok;
+}
+
+bool RFM2gRecorder::Rewind() {
+    bool ok = (file != NULL) && !writerStarted;
+    if (ok) {
+        ok = (fseek(file, static_cast<long>(sizeof(RFM2gRecordHeader)), SEEK_SET) == 0);
+    }
+    return ok;
+}
+
+bool RFM2gRecorder::NextFrame(RFM2gRecordFrame &frame) {
+    bool ok = (file != NULL) && !writerStarted;
+    if (ok) {
+        ok = (fread(&frame, sizeof(frame), 1u, file) == 1u);
+    }
+    return ok;
+}
+
+bool RFM2gRecorder::ReadPayload(const RFM2gRecordFrame &frame,
+                                void * const destination,
+                                const uint32 destinationSize) {
+    bool ok = (frame.size <= destinationSize);
+    if (ok) {
+        ok = (fread(destination, 1u, frame.size, file) == frame.size);
+    }
+    else {
+        (void) fseek(file, static_cast<long>(frame.size), SEEK_CUR);
+    }
+    return ok;
+}
+
+}
@@ -0,0 +1,199 @@
+/**
+ * @file RFM2gRecorder.h
+ * @brief Header file for class RFM2gRecorder
+ * @date 08/03/2021
+ * @authors Davide Liuzza, Luca Boncagni,  Cristian Galperti
+ *
+ *
+ * @copyright Copyright 2021 FSN-ENEA | Nuclear and Fusion Energy Department, ENEA Frascati (Rome)
+ * Italy.
+ * @copyright Copyright 2019 SPC | Swiss Plasma Center, EPFL Lausanne
+ * Switzerland.
+ * @copyright Copyright 2015 F4E | European Joint Undertaking for ITER and
+ * the Development of Fusion Energy ('Fusion for Energy').
+ * Licensed under the EUPL, Version 1.1 or - as soon they will be approved
+ * by the European Commission - subsequent versions of the EUPL (the "Licence")
+ * You may not use this work except in compliance with the Licence.
+ * You may obtain a copy of the Licence at: http://ec.europa.eu/idabc/eupl
+ *
+ * @warning Unless required by applicable law or agreed to in writing, 
+ * software distributed under the Licence is distributed on an "AS IS"
+ * basis, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+ * or implied. See the Licence permissions and limitations under the Licence.
+
+ * @details This header file contains the declaration of the class RFM2gRecorder
+ * used by the RFM2g DataSource to record the received ring frames and to replay them.
+ */
+
+#ifndef RFM2G_RECORDER_H_
+#define RFM2G_RECORDER_H_
+
+/*---------------------------------------------------------------------------*/
+/*                        Standard header includes                           */
+/*---------------------------------------------------------------------------*/
+#include <stdio.h>
+#include <pthread.h>
+
+/*---------------------------------------------------------------------------*/
+/*                        Project header includes                            */
+/*---------------------------------------------------------------------------*/
+#include "CompilerTypes.h"
+
+/*---------------------------------------------------------------------------*/
+/*                           Class declaration                               */
+/*---------------------------------------------------------------------------*/
+namespace MARTe {
+
+/**
+ * "RFMR", version of the record file layout
+ */
+const uint32 RFM2G_RECORD_MAGIC = 0x524D4652u;
+const uint32 RFM2G_RECORD_VERSION = 1u;
+
+/**
+ * The frame types: the protocol table of a new read plan and the raw input image of a cycle
+ */
+const uint32 RFM2G_RECORD_TABLE = 1u;
+const uint32 RFM2G_RECORD_IMAGE = 2u;
+
+/**
+ * The file header, checked against the configuration of the replaying DataSource
+ */
+struct RFM2gRecordHeader {
+    uint32 magic;
+    uint32 version;
+    uint32 numberOfHosts;
+    uint32 trailerSize;
+};
+
+/**
+ * The header of each frame, followed by size bytes of payload
+ */
+struct RFM2gRecordFrame {
+    uint32 type;
+    uint32 size;
+    int32 counter;
+    int32 time;
+    uint64 timestampNs;
+};
+
+/**
+ * @brief Records the frames received by the RFM2g DataSource in a file and reads them back.
+ * @details When recording, Record copies the frame in a preallocated ring of slots and never blocks nor
+ * allocates: a background thread writes the slots to the file. A frame that does not find a free slot
+ * (or does not fit a slot) is dropped and counted. When replaying, the frames are read sequentially.
+ */
+class RFM2gRecorder {
+public:
+
+    /**
+     * @brief Constructor. Neither recording nor replaying.
+     */
+    RFM2gRecorder();
+
+    /**
+     * @brief Stops the writer thread, flushing the recorded frames, and closes the file.
+     */
+    ~RFM2gRecorder();
+
+    /**
+     * @brief Creates the record file, allocates numberOfSlots slots of slotSize payload bytes and starts the writer thread.
+     */
+    bool OpenRecord(const char8 * const fileName,
+                    const uint32 numberOfHosts,
+                    const uint32 trailerSize,
+                    const uint32 slotSize,
+                    const uint32 numberOfSlots);
+
+    /**
+     * @brief Queues a frame for the writer thread. Real-time safe.
+     * @return false if the frame was dropped.
+     */
+    bool Record(const uint32 type,
+                const int32 counter,
+                const int32 time,
+                const uint64 timestampNs,
+                const void * const payload,
+                const uint32 size);
+
+    /**
+     * @brief The frames dropped since the record file was opened.
+     */
+    uint32 GetDropped() const;
+
+    /**
+     * @brief Opens a record file and checks that it was recorded with the same number of hosts and trailer.
+     */
+    bool OpenReplay(const char8 * const fileName,
+                    const uint32 numberOfHosts,
+                    const uint32 trailerSize);
+
+    /**
+     * @brief Moves back to the first frame.
+     */
+    bool Rewind();
+
+    /**
+     * @brief Reads the header of the next frame.
+     * @return false at the end of the file.
+     */
+    bool NextFrame(RFM2gRecordFrame &frame);
+
+    /**
+     * @brief Reads the payload of the frame returned by NextFrame.
+     * @details A payload larger than the destination is skipped and false is returned.
+     */
+    bool ReadPayload(const RFM2gRecordFrame &frame,
+                     void * const destination,
+                     const uint32 destinationSize);
+
+private:
+
+    /**
+     * @brief The writer thread body.
+     */
+    static void *WriterThread(void *recorder);
+
+    /**
+     * @brief Writes all the queued slots to the file.
+     */
+    void Drain();
+
+    /**
+     * The record or replay file
+     */
+    FILE *file;
+
+    /**
+     * The ring of slots (frame header and payload), their payload size and number
+     */
+    uint8 *ring;
+    uint32 slotSize;
+    uint32 numberOfSlots;
+
+    /**
+     * Next slot written by Record and next slot written to the file
+     */
+    volatile uint32 head;
+    volatile uint32 tail;
+
+    /**
+     * Dropped frames
+     */
+    volatile uint32 dropped;
+
+    /**
+     * The writer thread and its run flag
+     */
+    pthread_t writer;
+    bool writerStarted;
+    volatile bool writing;
+};
+
+}
+
+/*---------------------------------------------------------------------------*/
+/*                        Inline method definitions                          */
+/*---------------------------------------------------------------------------*/
+
+#endif /* RFM2G_RECORDER_H_ */
@@ -0,0 +1,152 @@
+/**
+ * @file RFM2gStatistics.h
+ * @brief Header file for the RFM2g statistics page
+ * @date 08/03/2021
+ * @authors Davide Liuzza, Luca Boncagni,  Cristian Galperti
+ *
+ *
+ * @copyright Copyright 2021 FSN-ENEA | Nuclear and Fusion Energy Department, ENEA Frascati (Rome)
+ * Italy.
+ * @copyright Copyright 2019 SPC | Swiss Plasma Center, EPFL Lausanne
+ * Switzerland.
+ * @copyright Copyright 2015 F4E | European Joint Undertaking for ITER and
+ * the Development of Fusion Energy ('Fusion for Energy').
+ * Licensed under the EUPL, Version 1.1 or - as soon they will be approved
+ * by the European Commission - subsequent versions of the EUPL (the "Licence")
+ * You may not use this work except in compliance with the Licence.
+ * You may obtain a copy of the Licence at: http://ec.europa.eu/idabc/eupl
+ *
+ * @warning Unless required by applicable law or agreed to in writing, 
+ * software distributed under the Licence is distributed on an "AS IS"
+ * basis, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+ * or implied. See the Licence permissions and limitations under the Licence.
+
+ * @details This header file contains the layout of the statistics page that the RFM2g DataSource
+ * publishes in a POSIX shared memory segment, and the seqlock used to write and read it.
+ * It does not depend on MARTe so that it can be used by the stand-alone viewer (RFM2gStatsViewer).
+ */
+
+#ifndef RFM2G_STATISTICS_H_
+#define RFM2G_STATISTICS_H_
+
+/*---------------------------------------------------------------------------*/
+/*                        Standard header includes                           */
+/*---------------------------------------------------------------------------*/
+#include <stdint.h>
+#include <string.h>
+
+/*---------------------------------------------------------------------------*/
+/*                        Project header includes                            */
+/*---------------------------------------------------------------------------*/
+
+/*---------------------------------------------------------------------------*/
+/*                           Class declaration                               */
+/*---------------------------------------------------------------------------*/
+
+//"RFMS"
+#define RFM2G_STATS_MAGIC   0x534D4652u
+#define RFM2G_STATS_VERSION 3u
+
+/**
+ * @brief The fixed part of the statistics page, followed by the per host arrays:
+ * int32_t counters[numberOfHosts], float diagnostics[numberOfHosts], uint32_t integrityFailures[numberOfHosts].
+ * @details sequence is odd while the page is being written (seqlock).
+ */
+struct RFM2gStatisticsPage {
+    uint32_t magic;
+    uint32_t version;
+    volatile uint32_t sequence;
+    uint32_t numberOfHosts;
+    uint32_t nodeIdNumber;
+    uint32_t master;
+    uint32_t masterNode;
+    uint32_t standbyDriving;
+
+    uint64_t cycles; //cycles processed since Run
+    int32_t counter;
+    int32_t time;
+    double realTime;
+    double ringTime;
+
+    uint32_t skippedCycles;
+    uint32_t lostCycles;
+    uint32_t lossEvents;
+    uint32_t masterStepRetries; //cumulative retries of rfm_master_step
+
+    double writeTimeUs; //last and maximum duration of the phases, in microseconds
+    double writeTimeMaxUs;
+    double readTimeUs;
+    double readTimeMaxUs;
+    double cycleTimeUs; //time between two processed cycles
+    double cycleTimeMaxUs;
+    double failoverTime;
+
+    uint32_t deadlineMisses; //cycles whose Read completed after the next master tick
+    uint32_t reserved;
+    double lastOverrunUs;
+    double worstOverrunUs;
+
+    double readBandwidth; //bytes per second moved by this node, measured every second
+    double writeBandwidth;
+    double ringLoad; //bytes per second written by all the hosts, from the protocol table
+    double ringBandwidth; //the configured ring bandwidth, 0 if not given
+};
+
+/**
+ * @brief The size of the page for numberOfHosts hosts.
+ */
+static inline uint32_t RFM2gStatisticsPageSize(const uint32_t numberOfHosts) {
+    return static_cast<uint32_t>(sizeof(RFM2gStatisticsPage)) + numberOfHosts * static_cast<uint32_t>(sizeof(int32_t) + sizeof(float) + sizeof(uint32_t));
+}
+
+/**
+ * @brief The per host arrays of the page.
+ */
+static inline int32_t *RFM2gStatisticsCounters(RFM2gStatisticsPage * const page) {
+    return reinterpret_cast<int32_t*>(page + 1);
+}
+
+static inline float *RFM2gStatisticsDiagnostics(RFM2gStatisticsPage * const page) {
+    return reinterpret_cast<float*>(RFM2gStatisticsCounters(page) + page->numberOfHosts);
+}
+
+static inline uint32_t *RFM2gStatisticsIntegrityFailures(RFM2gStatisticsPage * const page) {
+    return reinterpret_cast<uint32_t*>(RFM2gStatisticsDiagnostics(page) + page->numberOfHosts);
+}
+
+/**
+ * @brief Writer side of the seqlock: the page is copied from a private copy between two sequence increments.
+ * @details A single writer. Never blocks.
+ */
+static inline void RFM2gStatisticsPublish(RFM2gStatisticsPage * const page,
+                                          const RFM2gStatisticsPage * const source,
+                                          const uint32_t size) {
+    uint32_t sequence = page->sequence;
+    page->sequence = sequence + 1u;
+    __sync_synchronize();
+    //the header words (magic, version, sequence) are not copied
+    const uint32_t skip = static_cast<uint32_t>(3u * sizeof(uint32_t));
+    memcpy(reinterpret_cast<uint8_t*>(page) + skip, reinterpret_cast<const uint8_t*>(source) + skip, size - skip);
+    __sync_synchronize();
+    page->sequence = sequence + 2u;
+}
+
+/**
+ * @brief Reader side of the seqlock: copies the page in destination.
+ * @return false if the page was being written, the caller retries.
+ */
+static inline bool RFM2gStatisticsRead(const RFM2gStatisticsPage * const page,
+                                       RFM2gStatisticsPage * const destination,
+                                       const uint32_t size) {
+    uint32_t sequence = page->sequence;
+    __sync_synchronize();
+    memcpy(destination, page, size);
+    __sync_synchronize();
+    return ((sequence & 1u) == 0u) && (sequence == page->sequence);
+}
+
+/*---------------------------------------------------------------------------*/
+/*                        Inline method definitions                          */
+/*---------------------------------------------------------------------------*/
+
+#endif /* RFM2G_STATISTICS_H_ */
@@ -0,0 +1,132 @@
+/**
+ * @file RFM2gStatsViewer.cpp
+ * @brief Source file of the RFM2g statistics viewer
+ * @date 08/03/2021
+ * @authors Davide Liuzza, Luca Boncagni,  Cristian Galperti
+ *
+ *
+ * @copyright Copyright 2021 FSN-ENEA | Nuclear and Fusion Energy Department, ENEA Frascati (Rome)
+ * Italy.
+ * @copyright Copyright 2019 SPC | Swiss Plasma Center, EPFL Lausanne
+ * Switzerland.
+ * @copyright Copyright 2015 F4E | European Joint Undertaking for ITER and
+ * the Development of Fusion Energy ('Fusion for Energy').
+ * Licensed under the EUPL, Version 1.1 or - as soon they will be approved
+ * by the European Commission - subsequent versions of the EUPL (the "Licence")
+ * You may not use this work except in compliance with the Licence.
+ * You may obtain a copy of the Licence at: http://ec.europa.eu/idabc/eupl
+ *
+ * @warning Unless required by applicable law or agreed to in writing, 
+ * software distributed under the Licence is distributed on an "AS IS"
+ * basis, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+ * or implied. See the Licence permissions and limitations under the Licence.
+
+ * @details Stand-alone command line viewer of the statistics page published by the RFM2g DataSource
+ * (StatisticsName). It maps the page read-only and never interferes with the real-time application.
+ * Usage: RFM2gStatsViewer /rfm2g_node1 [refresh period in seconds]
+ */
+
+/*---------------------------------------------------------------------------*/
+/*                         Standard header includes                          */
+/*---------------------------------------------------------------------------*/
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+/*---------------------------------------------------------------------------*/
+/*                         Project header includes                           */
+/*---------------------------------------------------------------------------*/
+#include "RFM2gStatistics.h"
+
+/*---------------------------------------------------------------------------*/
+/*                           Static definitions                              */
+/*---------------------------------------------------------------------------*/
+
+/*---------------------------------------------------------------------------*/
+/*                           Method definitions                              */
+/*---------------------------------------------------------------------------*/
+
+int main(int argc,
+         char **argv) {
+
+    if (argc < 2) {
+        fprintf(stderr, "Usage: %s <StatisticsName> [refresh period in seconds]\n", argv[0]);
+        return 1;
+    }
+
+    double refreshPeriod = 1.0;
+    if (argc > 2) {
+        refreshPeriod = atof(argv[2]);
+    }
+
+    int fd = shm_open(argv[1], O_RDONLY, 0);
+    if (fd < 0) {
+        perror("shm_open");
+        return 1;
+    }
+
+    struct stat st;
+    if ((fstat(fd, &st) != 0) || (static_cast<uint32_t>(st.st_size) < sizeof(RFM2gStatisticsPage))) {
+        fprintf(stderr, "%s is not a statistics page\n", argv[1]);
+        close(fd);
+        return 1;
+    }
+
+    uint32_t size = static_cast<uint32_t>(st.st_size);
+    const RFM2gStatisticsPage *page = static_cast<const RFM2gStatisticsPage*>(mmap(NULL, size, PROT_READ, MAP_SHARED, fd, 0));
+    close(fd);
+    if (page == MAP_FAILED) {
+        perror("mmap");
+        return 1;
+    }
+
+    if ((page->magic != RFM2G_STATS_MAGIC) || (page->version != RFM2G_STATS_VERSION) || (RFM2gStatisticsPageSize(page->numberOfHosts) > size)) {
+        fprintf(stderr, "%s has an unknown layout\n", argv[1]);
+        return 1;
+    }
+
+    RFM2gStatisticsPage *copy = static_cast<RFM2gStatisticsPage*>(malloc(size));
+    if (copy == NULL) {
+        return 1;
+    }
+
+    for (;;) {
+        //the writer never waits for the readers, a torn copy is read again
+        while (!RFM2gStatisticsRead(page, copy, size)) {
+            usleep(100);
+        }
+
+        printf("\033[2J\033[H");
+        printf("RFM2g node %u (%s), ring driven by node %u%s\n", copy->nodeIdNumber, (copy->master != 0u) ? "master" : "slave", copy->masterNode,
+               (copy->standbyDriving != 0u) ? " (this standby)" : "");
+        printf("cycles %llu  counter %d  time %d  realTime %.6f s  ringTime %.6f s\n", static_cast<unsigned long long>(copy->cycles), copy->counter,
+               copy->time, copy->realTime, copy->ringTime);
+        printf("lost cycles %u (events %u, last skipped %u)  master step retries %u  failover %.6f s\n", copy->lostCycles, copy->lossEvents,
+               copy->skippedCycles, copy->masterStepRetries, copy->failoverTime);
+        printf("write %.2f us (max %.2f)  read %.2f us (max %.2f)  cycle %.2f us (max %.2f)\n", copy->writeTimeUs, copy->writeTimeMaxUs, copy->readTimeUs,
+               copy->readTimeMaxUs, copy->cycleTimeUs, copy->cycleTimeMaxUs);
+        printf("deadline misses %u  last overrun %.2f us  worst overrun %.2f us\n", copy->deadlineMisses, copy->lastOverrunUs, copy->worstOverrunUs);
+        printf("read %.3f MB/s  write %.3f MB/s  ring load %.3f MB/s", copy->readBandwidth * 1e-6, copy->writeBandwidth * 1e-6, copy->ringLoad * 1e-6);
+        if (copy->ringBandwidth > 0.0) {
+            printf(" (%.1f%% of %.3f MB/s)", 100.0 * copy->ringLoad / copy->ringBandwidth, copy->ringBandwidth * 1e-6);
+        }
+        printf("\n");
+        printf("\n%6s %12s %12s %10s\n", "host", "counter", "diagnostic", "crc fails");
+
+        const int32_t *counters = RFM2gStatisticsCounters(copy);
+        const float *diagnostics = RFM2gStatisticsDiagnostics(copy);
+        const uint32_t *integrityFailures = RFM2gStatisticsIntegrityFailures(copy);
+        uint32_t i;
+        for (i = 0u; i < copy->numberOfHosts; i++) {
+            printf("%6u %12d %12.1f %10u\n", i, counters[i], diagnostics[i], integrityFailures[i]);
+        }
+        fflush(stdout);
+
+        usleep(static_cast<useconds_t>(refreshPeriod * 1e6));
+    }
+
+    return 0;
+}
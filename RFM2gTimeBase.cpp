@@ -0,0 +1,134 @@
+/**
+ * @file RFM2gTimeBase.cpp
+ * @brief Source file for class RFM2gTimeBase
+ * @date 08/03/2021
+ * @authors Davide Liuzza, Luca Boncagni,  Cristian Galperti
+ *
+ *
+ * @copyright Copyright 2021 FSN-ENEA | Nuclear and Fusion Energy Department, ENEA Frascati (Rome)
+ * Italy.
+ * @copyright Copyright 2019 SPC | Swiss Plasma Center, EPFL Lausanne
+ * Switzerland.
+ * @copyright Copyright 2015 F4E | European Joint Undertaking for ITER and
+ * the Development of Fusion Energy ('Fusion for Energy').
+ * Licensed under the EUPL, Version 1.1 or - as soon they will be approved
+ * by the European Commission - subsequent versions of the EUPL (the "Licence")
+ * You may not use this work except in compliance with the Licence.
+ * You may obtain a copy of the Licence at: http://ec.europa.eu/idabc/eupl
+ *
+ * @warning Unless required by applicable law or agreed to in writing, 
+ * software distributed under the Licence is distributed on an "AS IS"
+ * basis, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+ * or implied. See the Licence permissions and limitations under the Licence.
+
+ * @details This source file contains the definition of all the methods for
+ * the class RFM2gTimeBase (public, protected, and private). Be aware that some
+ * methods, such as those inline could be defined on the header file, instead.
+ */
+
+#define DLL_API
+
+/*---------------------------------------------------------------------------*/
+/*                         Standard header includes                          */
+/*---------------------------------------------------------------------------*/
+#include <time.h>
+
+/*---------------------------------------------------------------------------*/
+/*                         Project header includes                           */
+/*---------------------------------------------------------------------------*/
+#include "RFM2gTimeBase.h"
+#include "HighResolutionTimer.h"
+#include "Sleep.h"
+
+/*---------------------------------------------------------------------------*/
+/*                           Static definitions                              */
+/*---------------------------------------------------------------------------*/
+
+/*---------------------------------------------------------------------------*/
+/*                           Method definitions                              */
+/*---------------------------------------------------------------------------*/
+namespace MARTe {
+
+RFM2gTimeBase::RFM2gTimeBase() {
+    referenceTicks = HighResolutionTimer::Counter();
+    referenceNs = 0u;
+    (void) RawNow(referenceNs);
+    nsPerTick = 1e9 * HighResolutionTimer::Period();
+    lastRefineTicks = referenceTicks;
+    refinePeriodTicks = HighResolutionTimer::Frequency();
+}
+
+bool RFM2gTimeBase::RawNow(uint64 &ns) {
+    struct timespec ts;
+    bool ok = (clock_gettime(CLOCK_MONOTONIC_RAW, &ts) == 0);
+    if (ok) {
+        ns = static_cast<uint64>(ts.tv_sec) * 1000000000ull + static_cast<uint64>(ts.tv_nsec);
+    }
+    return ok;
+}
+
+bool RFM2gTimeBase::Calibrate(const float64 calibrationPeriod) {
+    uint64 startNs = 0u;
+    uint64 stopNs = 0u;
+
+    uint64 startTicks = HighResolutionTimer::Counter();
+    bool ok = RawNow(startNs);
+
+    if (ok) {
+        Sleep::Sec(calibrationPeriod);
+    }
+
+    uint64 stopTicks = HighResolutionTimer::Counter();
+    if (ok) {
+        ok = RawNow(stopNs);
+    }
+
+    if (ok) {
+        ok = (stopTicks > startTicks) && (stopNs > startNs);
+    }
+
+    if (ok) {
+        float64 measuredNsPerTick = static_cast<float64>(stopNs - startNs) / static_cast<float64>(stopTicks - startTicks);
+        float64 nominalNsPerTick = 1e9 * HighResolutionTimer::Period();
+        float64 ratio = measuredNsPerTick / nominalNsPerTick;
+        ok = (ratio > 0.99) && (ratio < 1.01);
+        if (ok) {
+            referenceTicks = startTicks;
+            referenceNs = startNs;
+            nsPerTick = measuredNsPerTick;
+            lastRefineTicks = stopTicks;
+        }
+    }
+
+    return ok;
+}
+
+void RFM2gTimeBase::Refine() {
+    uint64 ticks = HighResolutionTimer::Counter();
+    if ((ticks - lastRefineTicks) >= refinePeriodTicks) {
+        uint64 ns = 0u;
+        uint64 nowTicks = HighResolutionTimer::Counter();
+        if (RawNow(ns)) {
+            if ((nowTicks > referenceTicks) && (ns > referenceNs)) {
+                //the whole baseline since the calibration, the error of a single clock read is spread over it
+                nsPerTick = static_cast<float64>(ns - referenceNs) / static_cast<float64>(nowTicks - referenceTicks);
+            }
+        }
+        lastRefineTicks = nowTicks;
+    }
+}
+
+uint64 RFM2gTimeBase::Now() const {
+    uint64 ticks = HighResolutionTimer::Counter();
+    return referenceNs + static_cast<uint64>(static_cast<float64>(ticks - referenceTicks) * nsPerTick);
+}
+
+float64 RFM2gTimeBase::GetFrequency() const {
+    return 1e9 / nsPerTick;
+}
+
+void RFM2gTimeBase::SetRefinePeriod(const float64 period) {
+    refinePeriodTicks = static_cast<uint64>(period * static_cast<float64>(HighResolutionTimer::Frequency()));
+}
+
+}
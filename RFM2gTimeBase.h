@@ -0,0 +1,118 @@
+/**
+ * @file RFM2gTimeBase.h
+ * @brief Header file for class RFM2gTimeBase
+ * @date 08/03/2021
+ * @authors Davide Liuzza, Luca Boncagni,  Cristian Galperti
+ *
+ *
+ * @copyright Copyright 2021 FSN-ENEA | Nuclear and Fusion Energy Department, ENEA Frascati (Rome)
+ * Italy.
+ * @copyright Copyright 2019 SPC | Swiss Plasma Center, EPFL Lausanne
+ * Switzerland.
+ * @copyright Copyright 2015 F4E | European Joint Undertaking for ITER and
+ * the Development of Fusion Energy ('Fusion for Energy').
+ * Licensed under the EUPL, Version 1.1 or - as soon they will be approved
+ * by the European Commission - subsequent versions of the EUPL (the "Licence")
+ * You may not use this work except in compliance with the Licence.
+ * You may obtain a copy of the Licence at: http://ec.europa.eu/idabc/eupl
+ *
+ * @warning Unless required by applicable law or agreed to in writing, 
+ * software distributed under the Licence is distributed on an "AS IS"
+ * basis, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+ * or implied. See the Licence permissions and limitations under the Licence.
+
+ * @details This header file contains the declaration of the class RFM2gTimeBase
+ * used by the RFM2g DataSource to convert the TSC counter in calibrated time.
+ */
+
+#ifndef RFM2G_TIMEBASE_H_
+#define RFM2G_TIMEBASE_H_
+
+/*---------------------------------------------------------------------------*/
+/*                        Standard header includes                           */
+/*---------------------------------------------------------------------------*/
+
+/*---------------------------------------------------------------------------*/
+/*                        Project header includes                            */
+/*---------------------------------------------------------------------------*/
+#include "CompilerTypes.h"
+
+/*---------------------------------------------------------------------------*/
+/*                           Class declaration                               */
+/*---------------------------------------------------------------------------*/
+namespace MARTe {
+
+/**
+ * @brief TSC (HighResolutionTimer::Counter) time base calibrated against CLOCK_MONOTONIC_RAW.
+ * @details The frequency is first measured over a short start-up period (Calibrate) and then refined online
+ * (Refine) over the whole baseline since the calibration, so that its error decreases with the running time.
+ * Now() does not make system calls and can be used in the real-time phase.
+ */
+class RFM2gTimeBase {
+public:
+
+    /**
+     * @brief Constructor. Uses the nominal HighResolutionTimer frequency until Calibrate is called.
+     */
+    RFM2gTimeBase();
+
+    /**
+     * @brief Measures the TSC frequency against CLOCK_MONOTONIC_RAW over calibrationPeriod seconds.
+     * @details Sleeps, must be called outside the real-time phase.
+     * @return true if the clock could be read and the measured frequency is within 1% of the nominal one.
+     */
+    bool Calibrate(const float64 calibrationPeriod);
+
+    /**
+     * @brief Refines the frequency if at least refinePeriod seconds elapsed since the last refinement.
+     * @details Costs a counter read when nothing has to be done and a vDSO clock_gettime otherwise.
+     */
+    void Refine();
+
+    /**
+     * @brief The current time (ns) in the CLOCK_MONOTONIC_RAW domain, from the TSC.
+     */
+    uint64 Now() const;
+
+    /**
+     * @brief The estimated TSC frequency in Hz.
+     */
+    float64 GetFrequency() const;
+
+    /**
+     * @brief Sets how often (seconds) Refine updates the frequency.
+     */
+    void SetRefinePeriod(const float64 period);
+
+private:
+
+    /**
+     * @brief Reads CLOCK_MONOTONIC_RAW in ns.
+     */
+    static bool RawNow(uint64 &ns);
+
+    /**
+     * The calibration reference: the counter and the CLOCK_MONOTONIC_RAW time read together
+     */
+    uint64 referenceTicks;
+    uint64 referenceNs;
+
+    /**
+     * The current conversion factor
+     */
+    float64 nsPerTick;
+
+    /**
+     * The counter at the last refinement and the refine period in ticks
+     */
+    uint64 lastRefineTicks;
+    uint64 refinePeriodTicks;
+};
+
+}
+
+/*---------------------------------------------------------------------------*/
+/*                        Inline method definitions                          */
+/*---------------------------------------------------------------------------*/
+
+#endif /* RFM2G_TIMEBASE_H_ */
@@ -37,6 +37,7 @@
 /*---------------------------------------------------------------------------*/
 #include "AdvancedErrorManagement.h"
 #include "RFM2g_nopolling.h"
+#include "RFM2gCRC32C.h"
 #include "MemoryMapSynchronisedInputBroker.h"
 #include "Threads.h"
 #include "EmbeddedThreadI.h"
@@ -46,6 +47,11 @@
 #include "signal.h"
 #include "string.h"
 #include <stdlib.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <sched.h>
 
 /*---------------------------------------------------------------------------*/
 /*                           Static definitions                              */
@@ -60,6 +66,57 @@ const uint32 RFM2G_EXEC_MODE_RTTHREAD = 1u;
  */
 const uint32 RFM2G_EXEC_MODE_SPAWNED = 2u;
 
+/**
+ * Index of an optional signal which has not been configured.
+ */
+const uint32 RFM2G_NO_SIGNAL = 0xFFFFFFFFu;
+
+/**
+ * Host of a read window given by ReadOffset.
+ */
+const uint32 RFM2G_NO_HOST = 0xFFFFFFFFu;
+
+/**
+ * Catch-up policies of a slave that has lost cycles: only the latest cycle is processed, the lost cycles are
+ * replayed (flagged) before the latest one, or a message is sent after a number of consecutive losses.
+ */
+const uint8 RFM2G_CATCHUP_LATEST = 0u;
+const uint8 RFM2G_CATCHUP_REPLAY = 1u;
+const uint8 RFM2G_CATCHUP_NOTIFY = 2u;
+
+/**
+ * The outcomes of posting a mailbox message: posted, refused (disabled, wrong destination or too large), another
+ * thread posting to the same destination, mailbox full, or RFM access failed.
+ */
+const uint8 RFM2G_MAILBOX_POSTED = 0u;
+const uint8 RFM2G_MAILBOX_INVALID = 1u;
+const uint8 RFM2G_MAILBOX_BUSY = 2u;
+const uint8 RFM2G_MAILBOX_FULL = 3u;
+const uint8 RFM2G_MAILBOX_FAILED = 4u;
+
+/**
+ * The messages reported from the real-time cycle through the deferred logger; the trace ones only with LogTrace=1.
+ */
+const uint32 RFM2G_LOG_MASTER_STEP_FAILED = 0u;
+const uint32 RFM2G_LOG_TERMINATION_SENT = 1u;
+const uint32 RFM2G_LOG_MAX_CYCLES = 2u;
+const uint32 RFM2G_LOG_NO_CURRENT_CYCLE = 3u;
+const uint32 RFM2G_LOG_MASTER_EPOCH = 4u;
+const uint32 RFM2G_LOG_TAKEOVER = 5u;
+const uint32 RFM2G_LOG_TAKEOVER_FAILED = 6u;
+const uint32 RFM2G_LOG_STANDBY_AGAIN = 7u;
+const uint32 RFM2G_LOG_CYCLE_LOSSES = 8u;
+const uint32 RFM2G_LOG_TRACE_MASTER = 9u;
+const uint32 RFM2G_LOG_TRACE_SLAVE = 10u;
+const uint32 RFM2G_LOG_TRACE_START = 11u;
+const uint32 RFM2G_LOG_DEADLINE_MISS = 12u;
+const uint32 RFM2G_LOG_PACING_SLIP = 13u;
+const uint32 RFM2G_LOG_PARAMETER_APPLY = 14u;
+const uint32 RFM2G_LOG_PARAMETER_INVALID = 15u;
+const uint32 RFM2G_LOG_EPOCH_JOINED = 16u;
+const uint32 RFM2G_LOG_TRACE_HOST = 17u;
+const uint32 RFM2G_LOG_MESSAGES = 18u;
+
 uint8 RFM2g::numberOfinstances = 0u;
 
 }
@@ -84,6 +141,10 @@ RFM2g::RFM2g() :
     usedma = 0;
     dmabufferaddr = 0u;
     waitdma = true;
+    mapmemory = false;
+    rfmmapped = false;
+    pRfmMemory = static_cast<volatile uint8*>(NULL);
+    rfmmemorysize = 0u;
     downsamplefactor = 1u;
     startcycle = 0u;
     master = false;
@@ -107,14 +168,74 @@ RFM2g::RFM2g() :
     oktorun = true;
     nOfHosts = 0u;
 
-    hostsProtocolInfo = static_cast<HostCounterProcInfo*>(NULL);
-    hostsToReadInfo = static_cast<HostReadMappingInfo*>(NULL);
-    initialHostToRead = -1;
-    finalHostToRead = 0;
-    inputsizeRemapped = 0u;
+    uint32 p;
+    for (p = 0u; p < 2u; p++) {
+        readPlans[p].hostsProtocolInfo = static_cast<HostCounterProcInfo*>(NULL);
+        readPlans[p].hostsToReadInfo = static_cast<HostReadMappingInfo*>(NULL);
+        readPlans[p].diagnosticRatio = static_cast<float32*>(NULL);
+        readPlans[p].hostsByOffset = static_cast<uint32*>(NULL);
+        readPlans[p].hostsToRead = static_cast<uint32*>(NULL);
+        readPlans[p].numberOfHostsToRead = 0u;
+        readPlans[p].transfers = static_cast<RFMReadTransferInfo*>(NULL);
+        readPlans[p].numberOfTransfers = 0u;
+        readPlans[p].copies = static_cast<RFMReadCopyInfo*>(NULL);
+        readPlans[p].numberOfCopies = 0u;
+        readPlans[p].inputsizeRemapped = 0u;
+        readPlans[p].inputBufferInternal = static_cast<uint8*>(NULL);
+        readPlans[p].inputBufferInternalSize = 0u;
+    }
+    activePlan = static_cast<HostReadPlan*>(NULL);
+    pendingPlan = static_cast<HostReadPlan*>(NULL);
+    lastPublishedPlan = static_cast<HostReadPlan*>(NULL);
+    inputbufferinternalsize = 0u;
     counterRead = static_cast<int32*>(NULL);
     diagnosticData = static_cast<float32*>(NULL);
-    diagnosticRatio = static_cast<float32*>(NULL);
+
+    integritycheck = false;
+    integritykeeplastgood = true;
+    trailersize = sizeof(int32);
+    integrityFailures = static_cast<uint32*>(NULL);
+    integrityFailuresSignalIdx = RFM2G_NO_SIGNAL;
+
+    discoveryepoch = 0u;
+    readmergethreshold = READ_MERGE_THRESHOLD;
+    logtrace = false;
+    faultsenabled = false;
+    stampedCounter = 0;
+    simulatedcard = false;
+    hostslots = 1u;
+    writeSlot = 0u;
+    freshnessgate = false;
+    hostDue = static_cast<bool*>(NULL);
+    hostFresh = static_cast<bool*>(NULL);
+    slotSecond = static_cast<bool*>(NULL);
+    slotCounter = static_cast<int32*>(NULL);
+    lastGateIteration = 0;
+    numberOfReadWindows = 0u;
+    catchuppolicy = RFM2G_CATCHUP_LATEST;
+    catchupmaxreplay = CATCHUP_MAX_REPLAY;
+    catchupnotifyafter = 1u;
+    skippedCycles = 0u;
+    lostCycles = 0u;
+    lossEvents = 0u;
+    cycleReplayed = 0u;
+    consecutiveLosses = 0u;
+    replayCycles = 0u;
+    cycleLossArmed = false;
+    skippedCyclesSignalIdx = RFM2G_NO_SIGNAL;
+    lostCyclesSignalIdx = RFM2G_NO_SIGNAL;
+    lossEventsSignalIdx = RFM2G_NO_SIGNAL;
+    cycleReplayedSignalIdx = RFM2G_NO_SIGNAL;
+    historydepth = 0u;
+    inputHistory = NULL_PTR(uint8*);
+    historyCounters = NULL_PTR(int32*);
+    historyIndex = 0u;
+    inputHistorySignalIdx = RFM2G_NO_SIGNAL;
+    historyCountersSignalIdx = RFM2G_NO_SIGNAL;
+    historyIndexSignalIdx = RFM2G_NO_SIGNAL;
+    readWindows = static_cast<ReadWindowInfo*>(NULL);
+    readWindowNames = static_cast<StreamString*>(NULL);
+    discoveryTimeOut = DISCOVERY_TIMEOUT_PERIOD;
 
     timeOutTicks = 0u;
     nodeIdNumber = 0u;
@@ -129,9 +250,136 @@ RFM2g::RFM2g() :
     realTimeOffset = 0;
     realTime = 0.0;
 
+    ringTime = 0.0;
+    ringTimeOffset = 0;
+    ringTimeWindowMin = 0;
+    ringTimeSamples = 0u;
+    ringTimeValid = false;
+    ringtimewindow = RING_TIME_WINDOW;
+    ringtimelatency = 0;
+    lastSeenIteration = 0;
+    ringTimeSignalIdx = RFM2G_NO_SIGNAL;
+
+    standby = false;
+    standbyDriving = false;
+    failoverperiods = FAILOVER_PERIODS;
+    failoverTicks = 0u;
+    masterPeriodTicks = 0u;
+    masterPeriodUs = 0.0;
+    lastIterationTicks = 0u;
+    discoveryWatchTicks = 0u;
+    iterationSeen = false;
+    nextStepTicks = 0u;
+    drivingIteration = 0;
+    drivingTime = 0.0;
+    drivingRingNs = 0u;
+    masterEpoch = 0u;
+    masterNode = 0u;
+    failoverTime = 0.0;
+    masterNodeSignalIdx = RFM2G_NO_SIGNAL;
+    failoverTimeSignalIdx = RFM2G_NO_SIGNAL;
+    masterPeriodNs = 0u;
+    masterpacing = false;
+    pacingstepphase = 0.0;
+    pacingreadphase = -1.0;
+    pacingStepPhaseTicks = 0u;
+    pacingReadPhaseTicks = 0u;
+    nextCycleTicks = 0u;
+    pacingSlips = 0u;
+    deadlineMisses = 0u;
+    lastOverrun = 0.0;
+    worstOverrun = 0.0;
+    deadlineMissesSignalIdx = RFM2G_NO_SIGNAL;
+    bytesRead = 0u;
+    bytesWritten = 0u;
+    bandwidthTicks = 0u;
+    readBandwidth = 0.0;
+    writeBandwidth = 0.0;
+    ringLoad = 0.0;
+    ringbandwidth = 0.0;
+    readBandwidthSignalIdx = RFM2G_NO_SIGNAL;
+    writeBandwidthSignalIdx = RFM2G_NO_SIGNAL;
+    ringLoadSignalIdx = RFM2G_NO_SIGNAL;
+    lastOverrunSignalIdx = RFM2G_NO_SIGNAL;
+    worstOverrunSignalIdx = RFM2G_NO_SIGNAL;
+
+    statisticsperiod = STATISTICS_PERIOD;
+    statisticsPage = static_cast<RFM2gStatisticsPage*>(NULL);
+    statisticsScratch = static_cast<RFM2gStatisticsPage*>(NULL);
+    statisticsSize = 0u;
+    statisticsCycles = 0u;
+    masterStepRetries = 0u;
+    writeTicks = 0u;
+    readTicks = 0u;
+    cycleTicks = 0u;
+    lastCycleTicks = 0u;
+    writeTicksMax = 0u;
+    readTicksMax = 0u;
+    cycleTicksMax = 0u;
+
+    recordbuffercycles = RECORD_BUFFER_CYCLES;
+    replaypaced = true;
+    recording = false;
+    replaying = false;
+    replayTable = static_cast<HostCounterProcInfo*>(NULL);
+    replayTableValid = false;
+    replayStarted = false;
+    replayFirstNs = 0u;
+    replayStartNs = 0u;
+    cycleFunction = &RFM2g::ReplayCycle;
+
     if (!synchSem.Create()) {
         REPORT_ERROR(ErrorManagement::FatalError, "Could not create EventSem.");
     }
+    parkthread = false;
+    parked = false;
+    threadParked = false;
+    if (!parkSem.Create()) {
+        REPORT_ERROR(ErrorManagement::FatalError, "Could not create the park EventSem.");
+    }
+    warmupcycles = 0u;
+    warmUpRemaining = 0u;
+    bulkenabled = false;
+    bulkoffset = 0u;
+    bulksize = 0u;
+    bulkbytespercycle = BULK_BYTES_PER_CYCLE;
+    bulkTxBuffer = static_cast<uint8*>(NULL);
+    bulkTxSize = 0u;
+    bulkTxSent = 0u;
+    bulkTxCRC = 0u;
+    bulkTxId = 0u;
+    bulkTxFragments = 0u;
+    bulkTxPending = false;
+    bulkRx = static_cast<RFM2gBulkReceiveState*>(NULL);
+    bulkRxAssembly = static_cast<uint8*>(NULL);
+    bulkRxComplete = static_cast<uint8*>(NULL);
+    bulkReceiverStarted = false;
+    bulkReceiving = false;
+    mailboxenabled = false;
+    mailboxoffset = 0u;
+    mailboxslots = MAILBOX_SLOTS;
+    mailboxmessagesize = MAILBOX_MESSAGE_SIZE;
+    mailboxTxHead = static_cast<uint32*>(NULL);
+    mailboxRxTail = static_cast<uint32*>(NULL);
+    mailboxTxSlot = static_cast<uint8*>(NULL);
+    mailboxTxMux = static_cast<FastPollingMutexSem*>(NULL);
+    mailboxRxMux = static_cast<FastPollingMutexSem*>(NULL);
+    parametersenabled = false;
+    parameteroffset = 0u;
+    parametersize = 0u;
+    parameters = static_cast<uint8*>(NULL);
+    parameterVersion = 0u;
+    parameterStaging = static_cast<uint8*>(NULL);
+    parameterStaged = false;
+    parameterStagedVersion = 0u;
+    parameterApplyCycle = 0;
+    parameterSeenVersion = 0u;
+    parameterFailures = 0u;
+    parameterPublishing = static_cast<uint8*>(NULL);
+    parameterPublished = 0u;
+    parameterPublishedApply = 0;
+    parametersSignalIdx = RFM2G_NO_SIGNAL;
+    parameterVersionSignalIdx = RFM2G_NO_SIGNAL;
 
     filter = ReferenceT < RegisteredMethodsMessageFilter > (GlobalObjectsDatabase::Instance()->GetStandardHeap());
     filter->SetDestination(this);
@@ -139,6 +387,8 @@ RFM2g::RFM2g() :
 
     cycles = 0;
     termmsgsent = false;
+    termMessagePending = false;
+    lossMessagePending = false;
     initruntime = -10000000;
     masterstepmaxretries = MASTERSTEP_MAX_RETRIES;
 }
@@ -148,11 +398,21 @@ RFM2g::~RFM2g() {
     if (!synchSem.Post()) {
         REPORT_ERROR(ErrorManagement::FatalError, "Could not post EventSem.");
     }
+    parked = false;
+    (void) parkSem.Post();
     if (!executor.Stop()) {
         if (!executor.Stop()) {
             REPORT_ERROR(ErrorManagement::FatalError, "Could not stop SingleThreadService.");
         }
     }
+    //the receiver reads the card, it is stopped before the card is closed
+    if (bulkReceiverStarted) {
+        bulkReceiving = false;
+        (void) pthread_join(bulkReceiver, NULL);
+        bulkReceiverStarted = false;
+        //the region is no longer announced to the other hosts
+        (void) PokeRFM32(bulkoffset + nodeIdNumber * bulksize + RFM2G_BULK_CHANNEL_OFFSET, 0u);
+    }
     if (rfmhandlevalid) {
         if (dmamapped) {
             if (RFM2gUnMapUserMemoryBytes(rfmhandle, (volatile void**) pDmaBuffer, dmabuffersize) != RFM2G_SUCCESS) {
@@ -163,6 +423,22 @@ RFM2g::~RFM2g() {
             }
         }
 
+        if (rfmmapped) {
+            if (RFM2gUnMapUserMemoryBytes(rfmhandle, (volatile void**) &pRfmMemory, rfmmemorysize) != RFM2G_SUCCESS) {
+                REPORT_ERROR(ErrorManagement::Information, "Could not unmap the memory of RFM2g device %s", rfmdevice);
+            }
+            else {
+                REPORT_ERROR(ErrorManagement::Information, "RFM2g device %s memory unmap successfully", rfmdevice);
+            }
+        }
+
+        //the master closes the discovery epoch, so that the slaves started before its next run wait for it
+        if (master && (discoveryepoch != 0u)) {
+            if (RFM2gPoke32(rfmhandle, RFM_DISCOVERY_EPOCH_OFFSET, discoveryepoch | RFM_DISCOVERY_CLOSED) != RFM2G_SUCCESS) {
+                REPORT_ERROR(ErrorManagement::Information, "Could not close the discovery epoch");
+            }
+        }
+
         // Closing device
         if (RFM2gClose(&(rfmhandle)) != RFM2G_SUCCESS) {
             REPORT_ERROR(ErrorManagement::FatalError, "Could not close RFM2g device %s", rfmdevice);
@@ -172,13 +448,54 @@ RFM2g::~RFM2g() {
         }
 
     }
+    else if (simulatedcard && rfmmapped) {
+        if (master && (discoveryepoch != 0u)) {
+            (void) PokeRFM32(RFM_DISCOVERY_EPOCH_OFFSET, discoveryepoch | RFM_DISCOVERY_CLOSED);
+        }
+        //the segment is shared with the other nodes, it is not unlinked
+        (void) munmap((void*) pRfmMemory, rfmmemorysize);
+    }
+
+    if (faultsenabled) {
+        uint32 f;
+        for (f = 0u; f < RFM2G_FAULTS; f++) {
+            if (faults.GetInjected(f) > 0u) {
+                REPORT_ERROR(ErrorManagement::Information, "Fault %s injected in %d cycles", RFM2gFaultInjector::GetName(f), faults.GetInjected(f));
+            }
+        }
+    }
 
-    if (hostsProtocolInfo != NULL) {
-        delete[] hostsProtocolInfo;
+    uint32 p;
+    for (p = 0u; p < 2u; p++) {
+        if (readPlans[p].hostsProtocolInfo != NULL) {
+            delete[] readPlans[p].hostsProtocolInfo;
+        }
+        if (readPlans[p].hostsToReadInfo != NULL) {
+            delete[] readPlans[p].hostsToReadInfo;
+        }
+        if (readPlans[p].diagnosticRatio != NULL) {
+            delete[] readPlans[p].diagnosticRatio;
+        }
+        if (readPlans[p].hostsByOffset != NULL) {
+            delete[] readPlans[p].hostsByOffset;
+        }
+        if (readPlans[p].hostsToRead != NULL) {
+            delete[] readPlans[p].hostsToRead;
+        }
+        if (readPlans[p].transfers != NULL) {
+            delete[] readPlans[p].transfers;
+        }
+        if (readPlans[p].copies != NULL) {
+            delete[] readPlans[p].copies;
+        }
+        //in DMA mode the plans share the DMA input area
+        if (!usedma && (readPlans[p].inputBufferInternal != NULL)) {
+            free(readPlans[p].inputBufferInternal);
+        }
     }
 
-    if (hostsToReadInfo != NULL) {
-        delete[] hostsToReadInfo;
+    if (!usedma && (pOutputBufferInternal != NULL)) {
+        free(pOutputBufferInternal);
     }
 
     if (counterRead != NULL) {
@@ -189,8 +506,108 @@ RFM2g::~RFM2g() {
         delete[] diagnosticData;
     }
 
-    if (diagnosticRatio != NULL) {
-        delete[] diagnosticRatio;
+    if (integrityFailures != NULL) {
+        delete[] integrityFailures;
+    }
+
+    if (hostDue != NULL) {
+        delete[] hostDue;
+    }
+
+    if (hostFresh != NULL) {
+        delete[] hostFresh;
+    }
+
+    if (slotSecond != NULL) {
+        delete[] slotSecond;
+    }
+
+    if (slotCounter != NULL) {
+        delete[] slotCounter;
+    }
+
+    if (readWindows != NULL) {
+        //the buffer of the first window is the InputBuffer
+        for (p = 1u; p < numberOfReadWindows; p++) {
+            if (readWindows[p].windowBuffer != NULL) {
+                delete[] readWindows[p].windowBuffer;
+            }
+        }
+        delete[] readWindows;
+    }
+
+    if (readWindowNames != NULL) {
+        delete[] readWindowNames;
+    }
+
+    if (statisticsPage != NULL) {
+        (void) munmap(statisticsPage, statisticsSize);
+        (void) shm_unlink(statisticsname.Buffer());
+    }
+
+    if (statisticsScratch != NULL) {
+        free(statisticsScratch);
+    }
+
+    if (inputHistory != NULL) {
+        delete[] inputHistory;
+    }
+
+    if (historyCounters != NULL) {
+        delete[] historyCounters;
+    }
+
+    //the logger thread sends the pending messages: it is stopped before the DataSource goes
+    logger.Stop();
+    if (logger.GetDropped() > 0u) {
+        REPORT_ERROR(ErrorManagement::Warning, "%d log records dropped (LogQueueSize too small)", logger.GetDropped());
+    }
+
+    if (recording && (recorder.GetDropped() > 0u)) {
+        REPORT_ERROR(ErrorManagement::Warning, "%d cycles could not be recorded in %s", recorder.GetDropped(), recordfile.Buffer());
+    }
+
+    if (replayTable != NULL) {
+        delete[] replayTable;
+    }
+
+    if (bulkTxBuffer != NULL) {
+        delete[] bulkTxBuffer;
+    }
+    if (bulkRx != NULL) {
+        delete[] bulkRx;
+    }
+    if (bulkRxAssembly != NULL) {
+        delete[] bulkRxAssembly;
+    }
+    if (bulkRxComplete != NULL) {
+        delete[] bulkRxComplete;
+    }
+
+    if (mailboxTxHead != NULL) {
+        delete[] mailboxTxHead;
+    }
+    if (mailboxRxTail != NULL) {
+        delete[] mailboxRxTail;
+    }
+    if (mailboxTxSlot != NULL) {
+        delete[] mailboxTxSlot;
+    }
+    if (mailboxTxMux != NULL) {
+        delete[] mailboxTxMux;
+    }
+    if (mailboxRxMux != NULL) {
+        delete[] mailboxRxMux;
+    }
+
+    if (parameters != NULL) {
+        delete[] parameters;
+    }
+    if (parameterStaging != NULL) {
+        delete[] parameterStaging;
+    }
+    if (parameterPublishing != NULL) {
+        delete[] parameterPublishing;
     }
 
 }
@@ -203,8 +620,11 @@ bool RFM2g::AllocateMemory() {
 
     if (usedma) {
         if (dmamapped) {
-            pInputBufferInternal = (void*) pDmaBuffer;
-            pOutputBufferInternal = (void*) ((uint8*) pDmaBuffer + inputsize + 256 * sizeof(int32)); // Here we assume that inputsize is in bytes (checked in SetConfiguredDatabase)
+            //the output (and its trailer) first, the rest of the DMA buffer is the input area shared by the read plans
+            pOutputBufferInternal = (void*) pDmaBuffer;
+            pInputBufferInternal = (void*) ((uint8*) pDmaBuffer + outputsize + trailersize); // Here we assume that inputsize is in bytes (checked in SetConfiguredDatabase)
+            //a read plan is accepted only if its remapped input fits here
+            inputbufferinternalsize = dmabuffersize - (outputsize + trailersize);
 
             pInputBuffer = (void*) (new uint8[inputsize]);
             pOutputBuffer = (void*) (new uint8[outputsize]);
@@ -217,15 +637,10 @@ bool RFM2g::AllocateMemory() {
 
     }
     else {
-        pInputBufferInternal = (void*) malloc(inputsize + 256 * sizeof(int32));
-
+        //the internal input buffer is owned by each read plan and sized exactly when the plan is built
         pInputBuffer = (void*) (new uint8[inputsize]);
 
-        if (pInputBufferInternal == NULL) {
-            REPORT_ERROR(ErrorManagement::FatalError, "Failed to allocate input buffer");
-            ok = false;
-        }
-        pOutputBufferInternal = (void*) malloc(outputsize + 256 * sizeof(int32));
+        pOutputBufferInternal = (void*) malloc(outputsize + trailersize);
 
         pOutputBuffer = (void*) (new uint8[outputsize]);
 
@@ -237,6 +652,32 @@ bool RFM2g::AllocateMemory() {
             REPORT_ERROR(ErrorManagement::Information, "RFM input/output buffer allocated successfully");
     }
 
+    if (ok) {
+        readWindows[0u].windowBuffer = (uint8*) pInputBuffer;
+        uint32 w = 0u;
+        for (w = 1u; (w < numberOfReadWindows) && ok; w++) {
+            readWindows[w].windowBuffer = new uint8[readWindows[w].windowSize];
+            ok = (readWindows[w].windowBuffer != NULL);
+            if (!ok) {
+                REPORT_ERROR(ErrorManagement::FatalError, "Failed to allocate the buffer of the read window %s", readWindowNames[w].Buffer());
+            }
+        }
+    }
+
+    if (ok && (historydepth > 0u)) {
+        inputHistory = new uint8[historydepth * inputsize];
+        historyCounters = new int32[historydepth];
+        ok = (inputHistory != NULL) && (historyCounters != NULL);
+        if (ok) {
+            memset(inputHistory, 0, historydepth * inputsize);
+            memset(historyCounters, 0, historydepth * sizeof(int32));
+            REPORT_ERROR(ErrorManagement::Information, "Input history of %d images allocated", historydepth);
+        }
+        else {
+            REPORT_ERROR(ErrorManagement::FatalError, "Failed to allocate the input history");
+        }
+    }
+
     return ok;
 }
 
@@ -289,6 +730,21 @@ bool RFM2g::Initialise(StructuredDataI &data) {
             Threads::PriorityClassType tmp = executor.GetPriorityClass();
             REPORT_ERROR(ErrorManagement::Information, "executor prio class id %d", tmp);
         }
+        if (ok) {
+            uint8 park;
+            if (data.Read("ParkThread", park)) {
+                parkthread = (park == 1u);
+            }
+            if (parkthread) {
+                REPORT_ERROR(ErrorManagement::Information, "ParkThread: the thread is parked in Idle instead of being stopped");
+            }
+        }
+    }
+
+    if (ok) {
+        if (!data.Read("WarmUpCycles", warmupcycles)) {
+            warmupcycles = 0u;
+        }
     }
 
     if (ok) {
@@ -303,11 +759,6 @@ bool RFM2g::Initialise(StructuredDataI &data) {
             REPORT_ERROR(ErrorManagement::ParametersError, "ReadOffset not set");
             ok = false;
         }
-        if (readoffset < RFM_SYSTEM_BUFFER) {
-            uint32 tmp = RFM_SYSTEM_BUFFER;
-            REPORT_ERROR(ErrorManagement::ParametersError, "ReadOffset <%d increase please", tmp);
-            ok = false;
-        }
 
     }
     if (ok) {
@@ -315,14 +766,6 @@ bool RFM2g::Initialise(StructuredDataI &data) {
             REPORT_ERROR(ErrorManagement::ParametersError, "WriteOffset not set");
             ok = false;
         }
-        if (writeoffset < RFM_SYSTEM_BUFFER) {
-            //REPORT_ERROR(ErrorManagement::ParametersError, "WriteOffset wrong, first");
-            uint32 tmp = RFM_SYSTEM_BUFFER;
-            REPORT_ERROR(ErrorManagement::ParametersError, "WriteOffset <%d increase please ", tmp);
-
-            //  REPORT_ERROR(ErrorManagement::ParametersError, "WriteOffset wrong, first %d bytes are reserved", RFM_SYSTEM_BUFFER);
-            ok = false;
-        }
     }
     uint8 tmp;
     if (ok) {
@@ -366,6 +809,46 @@ bool RFM2g::Initialise(StructuredDataI &data) {
             }
         }
     }
+    if (ok) {
+        if (data.Read("MapMemory", tmp)) {
+            mapmemory = (tmp == 1u);
+        }
+        if (mapmemory) {
+            REPORT_ERROR(ErrorManagement::Information, "RFM memory will be mapped in userspace for direct PIO access");
+        }
+    }
+    if (ok) {
+        if (data.Read("IntegrityCheck", tmp)) {
+            integritycheck = (tmp == 1u);
+        }
+        if (integritycheck) {
+            //the CRC32C of payload and counter is appended after the counter of each host
+            trailersize = 2u * sizeof(int32);
+
+            StreamString integrityPolicyStr;
+            if (!data.Read("IntegrityPolicy", integrityPolicyStr)) {
+                integrityPolicyStr = "KeepLastGood";
+                REPORT_ERROR(ErrorManagement::Warning, "IntegrityPolicy not specified using: %s", integrityPolicyStr.Buffer());
+            }
+            if (integrityPolicyStr == "KeepLastGood") {
+                integritykeeplastgood = true;
+            }
+            else if (integrityPolicyStr == "Flag") {
+                integritykeeplastgood = false;
+            }
+            else {
+                ok = false;
+                REPORT_ERROR(ErrorManagement::InitialisationError, "The IntegrityPolicy must be \"KeepLastGood\" or \"Flag\"");
+            }
+
+            if (RFM2gCRC32C::Initialise()) {
+                REPORT_ERROR(ErrorManagement::Information, "Integrity check enabled, CRC32C computed with SSE4.2 instructions");
+            }
+            else {
+                REPORT_ERROR(ErrorManagement::Information, "Integrity check enabled, CRC32C computed with slicing-by-8 tables");
+            }
+        }
+    }
     if (ok) {
         /* Synchronizing is set by the Frequency property of signals,
          * see GetBrokerName
@@ -432,6 +915,20 @@ bool RFM2g::Initialise(StructuredDataI &data) {
                     REPORT_ERROR(ErrorManagement::ParametersError, "MasterStepMaxRetries should be given in master mode. Default %d", masterstepmaxretries);
                 }
 
+                uint8 pacing;
+                if (data.Read("MasterPacing", pacing)) {
+                    masterpacing = (pacing == 1u);
+                }
+                if (masterpacing) {
+                    (void) data.Read("PacingStepPhase", pacingstepphase);
+                    (void) data.Read("PacingReadPhase", pacingreadphase);
+                    if (pacingstepphase < 0.0) {
+                        REPORT_ERROR(ErrorManagement::ParametersError, "PacingStepPhase must not be negative");
+                        ok = false;
+                    }
+                    REPORT_ERROR(ErrorManagement::Information, "MasterPacing: the cycles start on an absolute timeline");
+                }
+
             }
 
         }
@@ -442,6 +939,56 @@ bool RFM2g::Initialise(StructuredDataI &data) {
             REPORT_ERROR(ErrorManagement::ParametersError, "NumberOfHosts must be given");
             ok = false;
         }
+        else if (nOfHosts < 1u) {
+            REPORT_ERROR(ErrorManagement::ParametersError, "NumberOfHosts must be at least 1");
+            ok = false;
+        }
+        else {
+            //the reserved area grows with the protocol table
+            uint32 tmp = SystemBufferSize();
+            if (readoffset < tmp) {
+                REPORT_ERROR(ErrorManagement::ParametersError, "ReadOffset <%d increase please", tmp);
+                ok = false;
+            }
+            if (writeoffset < tmp) {
+                REPORT_ERROR(ErrorManagement::ParametersError, "WriteOffset <%d increase please ", tmp);
+                ok = false;
+            }
+        }
+
+        if (!data.Read("ReadMergeThreshold", readmergethreshold)) {
+            REPORT_ERROR(ErrorManagement::Information, "ReadMergeThreshold not given. Default is %d bytes", readmergethreshold);
+        }
+
+        if (!data.Read("RingBandwidth", ringbandwidth)) {
+            ringbandwidth = 0.0;
+        }
+
+        if (!data.Read("HistoryDepth", historydepth)) {
+            historydepth = 0u;
+        }
+
+        if (data.Read("PingPongSlots", tmp)) {
+            hostslots = (tmp == 1u) ? 2u : 1u;
+        }
+        if (hostslots == 2u) {
+            REPORT_ERROR(ErrorManagement::Information, "PingPongSlots: each host alternates between two slots of its segment");
+        }
+
+        if (data.Read("FreshnessGate", tmp)) {
+            freshnessgate = (tmp == 1u);
+        }
+        if (freshnessgate) {
+            REPORT_ERROR(ErrorManagement::Information, "FreshnessGate: only the hosts whose counter advanced are read");
+        }
+
+        if (!data.Read("DiscoveryTimeOut", discoveryTimeOut)) {
+            REPORT_ERROR(ErrorManagement::Information, "DiscoveryTimeOut not given. Default is %f seconds", discoveryTimeOut);
+        }
+
+        if (ok) {
+            ok = InitializeReadWindows(data);
+        }
 
     }
 
@@ -470,6 +1017,31 @@ bool RFM2g::Initialise(StructuredDataI &data) {
 
     }
 
+    if (ok) {
+        float64 calibrationPeriod = TIME_BASE_CALIBRATION_PERIOD;
+        if (!data.Read("TimeBaseCalibrationPeriod", calibrationPeriod)) {
+            REPORT_ERROR(ErrorManagement::Information, "TimeBaseCalibrationPeriod not given. Default is %f seconds", calibrationPeriod);
+        }
+        if (timeBase.Calibrate(calibrationPeriod)) {
+            REPORT_ERROR(ErrorManagement::Information, "TSC frequency calibrated against CLOCK_MONOTONIC_RAW: %f Hz (nominal %d Hz)", timeBase.GetFrequency(),
+                         HighResolutionTimer::Frequency());
+        }
+        else {
+            REPORT_ERROR(ErrorManagement::Warning, "TSC calibration failed, using the nominal frequency %d Hz", HighResolutionTimer::Frequency());
+        }
+
+        if (!data.Read("RingTimeWindow", ringtimewindow)) {
+            REPORT_ERROR(ErrorManagement::Information, "RingTimeWindow not given. Default is %d samples", ringtimewindow);
+        }
+        if (ringtimewindow < 1u) {
+            ringtimewindow = 1u;
+        }
+
+        if (!data.Read("RingTimeLatency", ringtimelatency)) {
+            ringtimelatency = 0;
+        }
+    }
+
     if (ok) {
         if (!data.Read("NodeIdNumber", nodeIdNumber)) {
             REPORT_ERROR(ErrorManagement::ParametersError, "NodeIdNumber must be given");
@@ -512,11 +1084,62 @@ bool RFM2g::Initialise(StructuredDataI &data) {
                 }
             }
 
+            StreamString catchUpPolicyStr;
+            if (!data.Read("CatchUpPolicy", catchUpPolicyStr)) {
+                catchUpPolicyStr = "Latest";
+            }
+            if (catchUpPolicyStr == "Latest") {
+                catchuppolicy = RFM2G_CATCHUP_LATEST;
+            }
+            else if (catchUpPolicyStr == "Replay") {
+                catchuppolicy = RFM2G_CATCHUP_REPLAY;
+                if (!data.Read("CatchUpMaxReplay", catchupmaxreplay)) {
+                    REPORT_ERROR(ErrorManagement::Information, "CatchUpMaxReplay not given. Default is %d cycles", catchupmaxreplay);
+                }
+            }
+            else if (catchUpPolicyStr == "Notify") {
+                catchuppolicy = RFM2G_CATCHUP_NOTIFY;
+                if (!data.Read("CatchUpNotifyAfter", catchupnotifyafter)) {
+                    REPORT_ERROR(ErrorManagement::Information, "CatchUpNotifyAfter not given. Default is %d consecutive losses", catchupnotifyafter);
+                }
+                lossMessage = Find("CycleLossMessage");
+                if (!lossMessage.IsValid()) {
+                    REPORT_ERROR(ErrorManagement::InitialisationError, "CatchUpPolicy Notify requires a +CycleLossMessage");
+                    ok = false;
+                }
+            }
+            else {
+                ok = false;
+                REPORT_ERROR(ErrorManagement::InitialisationError, "The CatchUpPolicy must be \"Latest\", \"Replay\" or \"Notify\"");
+            }
+
+            if (data.Read("Standby", tmp)) {
+                standby = (tmp == 1u);
+            }
+            if (standby) {
+                if (!data.Read("FailoverPeriods", failoverperiods)) {
+                    REPORT_ERROR(ErrorManagement::Information, "FailoverPeriods not given. Default is %d master periods", failoverperiods);
+                }
+                if (failoverperiods < 1u) {
+                    REPORT_ERROR(ErrorManagement::ParametersError, "FailoverPeriods must be greater than 0");
+                    ok = false;
+                }
+                REPORT_ERROR(ErrorManagement::Information, "Standby master: takes over after %d master periods without a new cycle", failoverperiods);
+            }
+
         }
     }
 
+    if (ok) {
+        ok = InitializeRecordReplay(data);
+    }
+
+    if (ok && !replaying) {
+        simulatedcard = (strncmp(device.Buffer(), RFM2G_SIMULATED_DEVICE_PREFIX, strlen(RFM2G_SIMULATED_DEVICE_PREFIX)) == 0);
+    }
+
     /**
-     * Opening the device
+     * Opening the device, not when replaying
      */
     if (device.Size() > 40) {
         REPORT_ERROR(ErrorManagement::InitialisationError, "Device name too long (max 40 characters)");
@@ -526,7 +1149,10 @@ bool RFM2g::Initialise(StructuredDataI &data) {
         strncpy(rfmdevice, device.Buffer(), 39);
     }
 
-    if (ok) {
+    if (ok && simulatedcard) {
+        ok = InitializeSimulatedCard(data);
+    }
+    else if (ok && !replaying) {
         if (RFM2gOpen(rfmdevice, &rfmhandle) != RFM2G_SUCCESS) {
             REPORT_ERROR(ErrorManagement::InitialisationError, "Error opening RFM2g device %s", rfmdevice);
             ok = false;
@@ -542,7 +1168,8 @@ bool RFM2g::Initialise(StructuredDataI &data) {
      */
     if (ok && rfmhandlevalid && usedma) {
 
-        dmabuffersize = dmabuffersize + 256 * sizeof(int32);  //here I reserve space for all the possible hosts counters
+        dmabuffersize = dmabuffersize + (nOfHosts * hostslots + 1u) * trailersize;  //here I reserve space for the counters (and CRCs) of the hosts and of the output
+        dmabuffersize = dmabuffersize + ReadMergeSlack();  //and for the gaps read when merging the transfers
 
         if (RFM2gUserMemoryBytes(rfmhandle, (volatile void**) &pDmaBuffer, dmabufferaddr | RFM2G_DMA_MMAP_OFFSET, dmabuffersize) != RFM2G_SUCCESS) {
             REPORT_ERROR(ErrorManagement::InitialisationError, "Coudn't map the userspace DMA buffer");
@@ -566,14 +1193,46 @@ bool RFM2g::Initialise(StructuredDataI &data) {
         }
     }
 
+    /**
+     * The size of the card bounds the regions, also without the mapping
+     */
+    if (ok && rfmhandlevalid) {
+        if (RFM2gSize(rfmhandle, &rfmmemorysize) != RFM2G_SUCCESS) {
+            REPORT_ERROR(ErrorManagement::InitialisationError, "Coudn't get the RFM memory size");
+            ok = false;
+        }
+    }
+
+    /**
+     * Mapping the RFM memory for direct PIO access
+     */
+    if (ok && rfmhandlevalid && mapmemory) {
+        if (RFM2gUserMemoryBytes(rfmhandle, (volatile void**) &pRfmMemory, 0u, rfmmemorysize) != RFM2G_SUCCESS) {
+            REPORT_ERROR(ErrorManagement::InitialisationError, "Coudn't map the RFM memory in userspace");
+            ok = false;
+        }
+        else {
+            REPORT_ERROR(ErrorManagement::Information, "RFM memory (%d bytes) mapped successfully in userspace", rfmmemorysize);
+            rfmmapped = true;
+        }
+    }
+
     if (ok) {
 
-        bool ok1 = InitializeHostsToReadInfo();
+        bool ok1 = InitializeReadPlans();
         bool ok2 = InitializeCounterRead();
         bool ok3 = InitializeDiagnosticData();
-        bool ok4 = InitializeDiagnosticRatio();
-
-        ok = ok1 && ok2 && ok3 && ok4;
+        bool ok4 = InitializeIntegrityFailures();
+        bool ok5 = InitializeStatistics(data);
+        bool ok6 = InitializeFreshnessGate();
+        bool ok7 = InitializeLogger(data);
+        bool ok8 = InitializeFaults(data);
+        bool ok9 = InitializeBulkChannel(data);
+        bool ok10 = ok9 && InitializeMailboxes(data);
+        bool ok11 = ok10 && InitializeParameters(data);
+        bool ok12 = InitializeHostSlots();
+
+        ok = ok1 && ok2 && ok3 && ok4 && ok5 && ok6 && ok7 && ok8 && ok9 && ok10 && ok11 && ok12;
 
         if (!ok) {
             REPORT_ERROR(ErrorManagement::InitialisationError, "Failed to allocate the diagnostic protocol info arrays");
@@ -581,7 +1240,7 @@ bool RFM2g::Initialise(StructuredDataI &data) {
 
     }
 
-    if (ok) {
+    if (ok && !replaying && !simulatedcard) {
 
         RFM2G_STATUS result;
         result = RFM2gNodeID(rfmhandle, &NodeId);
@@ -607,6 +1266,12 @@ bool RFM2g::Initialise(StructuredDataI &data) {
 
     if (ok) {
         fastMux.Create();
+        planMux.Create();
+    }
+
+    //the role, the thread model and the transfer mode are known: the cycle is selected once
+    if (ok) {
+        SelectCycle();
     }
 
     return ok;
@@ -763,56 +1428,169 @@ bool RFM2g::SetConfiguredDatabase(StructuredDataI &data) {
         }
     }
 
-    /*
-     * If DMA is enabled, the size of inputbuffer+outputbuffer must be less that the allocated DMA buffer
-     */
-    if (usedma) {
-        if (inputsize > (dmabuffersize / 2)) {
-            REPORT_ERROR(ErrorManagement::ParametersError, "In DMA mode inputsize buffer size (%d) must not be greater that DMA buffer size / 2 (%d)",
-                         inputsize, dmabuffersize / 2);
-            ok = false;
-        }
-        if (outputsize > (dmabuffersize / 2)) {
-            REPORT_ERROR(ErrorManagement::ParametersError, "In DMA mode output buffer size (%d) must not be greater that DMA buffer size / 2 (%d)", outputsize,
-                         dmabuffersize / 2);
-            ok = false;
-        }
-
+    if (ok) {
+        ok = GetOptionalSignalIndex("IntegrityFailures", UnsignedInteger32Bit, nOfHosts, integrityFailuresSignalIdx);
     }
-
-    if (!master && !synchronising && executionMode != RFM2G_EXEC_MODE_SPAWNED) {
-        REPORT_ERROR(ErrorManagement::ParametersError, "RFM2g in not master mode and not synchronizing mode must be placed on a separated thread");
-        ok = false;
+    if (ok) {
+        ok = GetOptionalSignalIndex("RingTime", Float64Bit, 1u, ringTimeSignalIdx);
     }
-
-    if (!master && !synchronising && executionMode == RFM2G_EXEC_MODE_SPAWNED) {
-        REPORT_ERROR(ErrorManagement::ParametersError, "RFM2g in not master mode and not synchronizing spawned isn't implemented yet");
-        ok = false;
+    if (ok) {
+        ok = GetOptionalSignalIndex("MasterNode", UnsignedInteger32Bit, 1u, masterNodeSignalIdx);
     }
-
-    if (master && executionMode == RFM2G_EXEC_MODE_SPAWNED) {
-        REPORT_ERROR(ErrorManagement::ParametersError, "RFM2g in master mode must not be placed on a separated thread");
-        ok = false;
+    if (ok) {
+        ok = GetOptionalSignalIndex("FailoverTime", Float64Bit, 1u, failoverTimeSignalIdx);
     }
-
     if (ok) {
-
-
-        (void) fastMuxRFM.FastLock(TTInfiniteWait, 0.);  //multithread
-        ok = SetDiagnosticOwnData();
-        fastMuxRFM.FastUnLock();
+        ok = GetOptionalSignalIndex("ReadBandwidth", Float64Bit, 1u, readBandwidthSignalIdx);
     }
-
-    REPORT_ERROR(ErrorManagement::Information, "Input  buffer length %d, starting at %d", inputsize, readoffset);
-    REPORT_ERROR(ErrorManagement::Information, "Output buffer length %d, starting at %d", outputsize, writeoffset);
-
-    return ok;
-}
-
-uint32 RFM2g::GetNumberOfMemoryBuffers() {
-    // TODO: check this
-
-    return 1u;
+    if (ok) {
+        ok = GetOptionalSignalIndex("WriteBandwidth", Float64Bit, 1u, writeBandwidthSignalIdx);
+    }
+    if (ok) {
+        ok = GetOptionalSignalIndex("RingLoad", Float64Bit, 1u, ringLoadSignalIdx);
+    }
+    if (ok) {
+        ok = GetOptionalSignalIndex("DeadlineMisses", UnsignedInteger32Bit, 1u, deadlineMissesSignalIdx);
+    }
+    if (ok) {
+        ok = GetOptionalSignalIndex("LastOverrun", Float64Bit, 1u, lastOverrunSignalIdx);
+    }
+    if (ok) {
+        ok = GetOptionalSignalIndex("WorstOverrun", Float64Bit, 1u, worstOverrunSignalIdx);
+    }
+    if (ok) {
+        ok = GetOptionalSignalIndex("SkippedCycles", UnsignedInteger32Bit, 1u, skippedCyclesSignalIdx);
+    }
+    if (ok) {
+        ok = GetOptionalSignalIndex("LostCycles", UnsignedInteger32Bit, 1u, lostCyclesSignalIdx);
+    }
+    if (ok) {
+        ok = GetOptionalSignalIndex("LossEvents", UnsignedInteger32Bit, 1u, lossEventsSignalIdx);
+    }
+    if (ok) {
+        ok = GetOptionalSignalIndex("CycleReplayed", UnsignedInteger8Bit, 1u, cycleReplayedSignalIdx);
+    }
+    if (ok) {
+        ok = GetOptionalSignalIndex("InputHistory", UnsignedInteger8Bit, historydepth * inputsize, inputHistorySignalIdx);
+    }
+    if (ok) {
+        ok = GetOptionalSignalIndex("HistoryCounters", SignedInteger32Bit, historydepth, historyCountersSignalIdx);
+    }
+    if (ok) {
+        ok = GetOptionalSignalIndex("HistoryIndex", UnsignedInteger32Bit, 1u, historyIndexSignalIdx);
+    }
+    if (ok && (historydepth == 0u) && (inputHistorySignalIdx != RFM2G_NO_SIGNAL)) {
+        REPORT_ERROR(ErrorManagement::ParametersError, "The InputHistory signal requires HistoryDepth");
+        ok = false;
+    }
+    if (ok) {
+        ok = GetOptionalSignalIndex("Parameters", UnsignedInteger8Bit, parametersize, parametersSignalIdx);
+    }
+    if (ok) {
+        ok = GetOptionalSignalIndex("ParameterVersion", UnsignedInteger32Bit, 1u, parameterVersionSignalIdx);
+    }
+    if (ok && (!parametersenabled) && (parametersSignalIdx != RFM2G_NO_SIGNAL)) {
+        REPORT_ERROR(ErrorManagement::ParametersError, "The Parameters signal requires ParameterOffset");
+        ok = false;
+    }
+
+    //each read window is read in the signal with its name, sized in bytes by the signal
+    uint32 totalwindowsize = 0u;
+    if (ok) {
+        readWindows[0u].windowSize = inputsize;
+        totalwindowsize = inputsize;
+        uint32 w = 0u;
+        for (w = 1u; (w < numberOfReadWindows) && ok; w++) {
+            ok = GetSignalIndex(readWindows[w].windowSignalIdx, readWindowNames[w].Buffer());
+            if (ok) {
+                ok = GetSignalByteSize(readWindows[w].windowSignalIdx, readWindows[w].windowSize);
+            }
+            if (!ok) {
+                REPORT_ERROR(ErrorManagement::ParametersError, "The read window %s must have a signal with the same name", readWindowNames[w].Buffer());
+            }
+            totalwindowsize = totalwindowsize + readWindows[w].windowSize;
+        }
+    }
+
+    //the regions above the reserved area are checked once the signals size the data segment and the windows
+    if (ok && bulkenabled) {
+        ok = RegionClearOfData("bulk regions", bulkoffset, static_cast<uint64>(bulkoffset) + static_cast<uint64>(nOfHosts) * bulksize);
+    }
+    if (ok && mailboxenabled) {
+        ok = RegionClearOfData("mailboxes", mailboxoffset, MailboxAddress(nOfHosts, 0u));
+    }
+    if (ok && parametersenabled) {
+        ok = RegionClearOfData("parameter block", parameteroffset,
+                               static_cast<uint64>(parameteroffset) + sizeof(RFM2gParameterHeader) + parametersize);
+    }
+
+    /*
+     * If DMA is enabled, the size of inputbuffer+outputbuffer must be less that the allocated DMA buffer
+     */
+    if (usedma) {
+        //with PingPongSlots both slots of the windows are read
+        if ((totalwindowsize * hostslots) > (dmabuffersize / 2)) {
+            REPORT_ERROR(ErrorManagement::ParametersError, "In DMA mode inputsize buffer size (%d, %d slots) must not be greater that DMA buffer size / 2 (%d)",
+                         totalwindowsize, hostslots, dmabuffersize / 2);
+            ok = false;
+        }
+        if (outputsize > (dmabuffersize / 2)) {
+            REPORT_ERROR(ErrorManagement::ParametersError, "In DMA mode output buffer size (%d) must not be greater that DMA buffer size / 2 (%d)", outputsize,
+                         dmabuffersize / 2);
+            ok = false;
+        }
+
+    }
+
+    //the slave cycle only implements the synchronising side: it is checked here once, not in the cycle
+    if (!master && !synchronising) {
+        if (executionMode != RFM2G_EXEC_MODE_SPAWNED) {
+            REPORT_ERROR(ErrorManagement::ParametersError, "RFM2g in not master mode and not synchronizing mode must be placed on a separated thread");
+        }
+        else {
+            REPORT_ERROR(ErrorManagement::ParametersError, "RFM2g in not master mode and not synchronizing spawned isn't implemented yet");
+        }
+        ok = false;
+    }
+
+    if (master && executionMode == RFM2G_EXEC_MODE_SPAWNED) {
+        REPORT_ERROR(ErrorManagement::ParametersError, "RFM2g in master mode must not be placed on a separated thread");
+        ok = false;
+    }
+
+    if (ok && !replaying) {
+
+
+        (void) fastMuxRFM.FastLock(TTInfiniteWait, 0.);  //multithread
+        ok = SetDiagnosticOwnData();
+        fastMuxRFM.FastUnLock();
+    }
+
+    //a slot holds the largest remapped input (the windows, the counters and the merged gaps) or a protocol table
+    if (ok && recording) {
+        uint32 slotSize = totalwindowsize + nOfHosts * trailersize + ReadMergeSlack();
+        if (slotSize < nOfHosts * SIZE_OF_HOST_PROTOCOL_DATA) {
+            slotSize = nOfHosts * SIZE_OF_HOST_PROTOCOL_DATA;
+        }
+        ok = recorder.OpenRecord(recordfile.Buffer(), nOfHosts, trailersize, slotSize, recordbuffercycles);
+        if (ok) {
+            REPORT_ERROR(ErrorManagement::Information, "Recording in %s, %d cycles of %d bytes buffered", recordfile.Buffer(), recordbuffercycles, slotSize);
+        }
+        else {
+            REPORT_ERROR(ErrorManagement::InitialisationError, "Could not create the record file %s", recordfile.Buffer());
+        }
+    }
+
+    REPORT_ERROR(ErrorManagement::Information, "Input  buffer length %d, starting at %d", inputsize, readoffset);
+    REPORT_ERROR(ErrorManagement::Information, "Output buffer length %d, starting at %d", outputsize, writeoffset);
+
+    return ok;
+}
+
+uint32 RFM2g::GetNumberOfMemoryBuffers() {
+    //the past input images are in the InputHistory signal, not in further state buffers
+
+    return 1u;
 }
 
 /*lint -e{715}  [MISRA C++ Rule 0-1-11], [MISRA C++ Rule 0-1-12]. Justification: The memory buffer is independent of the bufferIdx.*/
@@ -844,6 +1622,71 @@ bool RFM2g::GetSignalMemoryBuffer(const uint32 signalIdx,
         void *diagnosticDataout = static_cast<void*>(diagnosticData);
         signalAddress = diagnosticDataout;
     }
+    else if (signalIdx == integrityFailuresSignalIdx) {
+        signalAddress = static_cast<void*>(integrityFailures);
+    }
+    else if (signalIdx == ringTimeSignalIdx) {
+        signalAddress = static_cast<void*>(&ringTime);
+    }
+    else if (signalIdx == masterNodeSignalIdx) {
+        signalAddress = static_cast<void*>(&masterNode);
+    }
+    else if (signalIdx == failoverTimeSignalIdx) {
+        signalAddress = static_cast<void*>(&failoverTime);
+    }
+    else if (signalIdx == readBandwidthSignalIdx) {
+        signalAddress = static_cast<void*>(&readBandwidth);
+    }
+    else if (signalIdx == writeBandwidthSignalIdx) {
+        signalAddress = static_cast<void*>(&writeBandwidth);
+    }
+    else if (signalIdx == ringLoadSignalIdx) {
+        signalAddress = static_cast<void*>(&ringLoad);
+    }
+    else if (signalIdx == deadlineMissesSignalIdx) {
+        signalAddress = static_cast<void*>(&deadlineMisses);
+    }
+    else if (signalIdx == lastOverrunSignalIdx) {
+        signalAddress = static_cast<void*>(&lastOverrun);
+    }
+    else if (signalIdx == worstOverrunSignalIdx) {
+        signalAddress = static_cast<void*>(&worstOverrun);
+    }
+    else if (signalIdx == skippedCyclesSignalIdx) {
+        signalAddress = static_cast<void*>(&skippedCycles);
+    }
+    else if (signalIdx == lostCyclesSignalIdx) {
+        signalAddress = static_cast<void*>(&lostCycles);
+    }
+    else if (signalIdx == lossEventsSignalIdx) {
+        signalAddress = static_cast<void*>(&lossEvents);
+    }
+    else if (signalIdx == cycleReplayedSignalIdx) {
+        signalAddress = static_cast<void*>(&cycleReplayed);
+    }
+    else if (signalIdx == inputHistorySignalIdx) {
+        signalAddress = static_cast<void*>(inputHistory);
+    }
+    else if (signalIdx == historyCountersSignalIdx) {
+        signalAddress = static_cast<void*>(historyCounters);
+    }
+    else if (signalIdx == historyIndexSignalIdx) {
+        signalAddress = static_cast<void*>(&historyIndex);
+    }
+    else if (signalIdx == parametersSignalIdx) {
+        signalAddress = static_cast<void*>(parameters);
+    }
+    else if (signalIdx == parameterVersionSignalIdx) {
+        signalAddress = static_cast<void*>(&parameterVersion);
+    }
+    else {
+        uint32 w = 0u;
+        for (w = 1u; w < numberOfReadWindows; w++) {
+            if (signalIdx == readWindows[w].windowSignalIdx) {
+                signalAddress = static_cast<void*>(readWindows[w].windowBuffer);
+            }
+        }
+    }
 
     return ok;
 }
@@ -904,6 +1747,24 @@ const char8* RFM2g::GetBrokerName(StructuredDataI &data,
 bool RFM2g::Synchronise() {
     ErrorManagement::ErrorType err = ErrorManagement::NoError;
 
+    //the lost cycles to be replayed are run without waiting for a new cycle
+    bool catchUpReplay = false;
+    if (!master) {
+        (void) fastMux.FastLock(TTInfiniteWait, 0.);
+        catchUpReplay = (replayCycles > 0u);
+        fastMux.FastUnLock();
+    }
+
+    if (catchUpReplay) {
+        (void) fastMux.FastLock(TTInfiniteWait, 0.);
+        replayCycles--;
+        counterAndTimer[0] = counterEmbedded - static_cast<int32>(replayCycles);
+        cycleReplayed = (replayCycles > 0u) ? 1u : 0u;
+        fastMux.FastUnLock();
+
+        return true;
+    }
+
     if (!master) {
         (void) fastMux.FastLock(TTInfiniteWait, 0.);
         counterAndTimer[0]++;
@@ -920,6 +1781,10 @@ bool RFM2g::Synchronise() {
      ////////////////////
      */
 
+    if (faultsenabled) {
+        faults.Delay(RFM2G_FAULT_JITTER);
+    }
+
     if (executionMode == RFM2G_EXEC_MODE_SPAWNED) {
         //	bool notRunning = ( EmbeddedThreadI::RunningState);
 //	if(!notRunning)
@@ -929,13 +1794,6 @@ bool RFM2g::Synchronise() {
         else
             err = synchSem.ResetWait(1000);
 
-#ifdef _DEBUG
-
-                REPORT_ERROR(ErrorManagement::Information, "cycle Triggered");
-
-
-#endif
-
     }
     else {
         if (master) {
@@ -956,9 +1814,18 @@ bool RFM2g::Synchronise() {
     }
 
     if (!master) {
-        if (counterAndTimer[0] != counterEmbedded) {
+        (void) fastMux.FastLock(TTInfiniteWait, 0.);
+        if (replayCycles > 0u) {
+            //the first lost cycle, the latest one is the last to be run
+            replayCycles--;
+            counterAndTimer[0] = counterEmbedded - static_cast<int32>(replayCycles);
+            cycleReplayed = (replayCycles > 0u) ? 1u : 0u;
+        }
+        else {
             counterAndTimer[0] = counterEmbedded;
+            cycleReplayed = 0u;
         }
+        fastMux.FastUnLock();
     }
 
     /*
@@ -976,7 +1843,32 @@ bool RFM2g::PrepareNextState(const char8 *const currentStateName,
 
     REPORT_ERROR(ErrorManagement::Warning, "Prepare state %s ", nextStateName);
     if (!strcmp(nextStateName, "Idle")) {
-        if (executionMode == RFM2G_EXEC_MODE_SPAWNED) {
+        if ((executionMode == RFM2G_EXEC_MODE_SPAWNED) && parkthread) {
+            //the thread ends its cycle and waits for the next Run, the state is not touched until it is parked
+            (void) parkSem.Reset();
+            parked = true;
+            synchSem.Post();
+            //the cycle in progress may wait for the master up to the TimeOut before it sees the request
+            uint32 maxWait = 10u * PARK_WAIT_MS + static_cast<uint32>((timeOutTicks * 1000u) / HighResolutionTimer::Frequency());
+            uint32 waited = 0u;
+            while (!threadParked && (executor.GetStatus() == EmbeddedThreadI::RunningState) && (waited < maxWait)) {
+                Sleep::MSec(1u);
+                waited++;
+            }
+            if (threadParked) {
+                REPORT_ERROR(ErrorManagement::Information, "Independent Thread parked after %d ms", waited);
+            }
+            else if (executor.GetStatus() == EmbeddedThreadI::RunningState) {
+                //never left running in a state it could touch: stopped as without ParkThread, started again by the next Run
+                ok = executor.Stop();
+                REPORT_ERROR(ErrorManagement::Warning, "Independent Thread not parked after %d ms, Stop %d", waited, ok);
+                synchSem.Post();
+            }
+            else {
+                REPORT_ERROR(ErrorManagement::Warning, "Independent Thread not running, not parked");
+            }
+        }
+        else if (executionMode == RFM2G_EXEC_MODE_SPAWNED) {
             if (executor.GetStatus() == EmbeddedThreadI::RunningState) {
                 //Sleep::Sec(0.5);
                 ok = executor.Stop();
@@ -988,8 +1880,12 @@ bool RFM2g::PrepareNextState(const char8 *const currentStateName,
     }
 
     if (!strcmp(nextStateName, "Run")) {
+        warmUpRemaining = warmupcycles;
+
+        //a parked thread is released at the end of the state reset
         if (executionMode == RFM2G_EXEC_MODE_SPAWNED) {
             if (executor.GetStatus() == EmbeddedThreadI::OffState) {
+                parked = parkthread;
 
                 REPORT_ERROR(ErrorManagement::Warning, "Independent Thread Starting ");
                 ok = executor.Start();
@@ -1000,24 +1896,129 @@ bool RFM2g::PrepareNextState(const char8 *const currentStateName,
         counterAndTimer[1] = 0u;
         realTimeOffset = 0;
         realTime = 0.0;
-
-        memset(pInputBufferInternal, 0, inputsizeRemapped);
-        memset(pOutputBufferInternal, 0, outputsize + sizeof(int32));
-        if (usedma)
-            RFM2gWriteDMAwaitfinish(rfmhandle, writeoffset + nodeIdNumber * sizeof(int32), pOutputBufferInternal, outputsize + sizeof(int32));
-        else
-            RFM2gWriteDMA(rfmhandle, writeoffset + nodeIdNumber * sizeof(int32), pOutputBufferInternal, outputsize + sizeof(int32));
+        ringTime = 0.0;
+
+        skippedCycles = 0u;
+        lostCycles = 0u;
+        lossEvents = 0u;
+        cycleReplayed = 0u;
+        consecutiveLosses = 0u;
+        replayCycles = 0u;
+        cycleLossArmed = false;
+
+        //the expected master period, from the Frequency of this node and its DownSampleFactor
+        masterPeriodUs = (downsamplefactor > 0u) ? (static_cast<float64>(period) / static_cast<float64>(downsamplefactor)) : 0.0;
+        masterPeriodTicks = static_cast<uint64>(masterPeriodUs * 1e-6 * static_cast<float64>(HighResolutionTimer::Frequency()));
+        failoverTicks = failoverperiods * masterPeriodTicks;
+        masterPeriodNs = static_cast<uint64>(masterPeriodUs * 1e3);
+
+        //the phases of the paced master cycle, the read after the TimeOut from the step if not given
+        if (master && masterpacing) {
+            float64 ticksPerUs = static_cast<float64>(HighResolutionTimer::Frequency()) * 1e-6;
+            pacingStepPhaseTicks = static_cast<uint64>(pacingstepphase * ticksPerUs);
+            pacingReadPhaseTicks = (pacingreadphase < 0.0) ? (pacingStepPhaseTicks + timeOutTicks) : static_cast<uint64>(pacingreadphase * ticksPerUs);
+            nextCycleTicks = 0u;
+            pacingSlips = 0u;
+            if (masterPeriodTicks == 0u) {
+                REPORT_ERROR(ErrorManagement::ParametersError, "MasterPacing requires the Frequency of the master");
+                ok = false;
+            }
+            else if ((pacingReadPhaseTicks < pacingStepPhaseTicks) || (pacingReadPhaseTicks >= masterPeriodTicks)) {
+                REPORT_ERROR(ErrorManagement::ParametersError, "The PacingReadPhase must follow the PacingStepPhase within the period of %f us",
+                             masterPeriodUs);
+                ok = false;
+            }
+        }
+        deadlineMisses = 0u;
+        lastOverrun = 0.0;
+        worstOverrun = 0.0;
+        bytesRead = 0u;
+        bytesWritten = 0u;
+        bandwidthTicks = 0u;
+        readBandwidth = 0.0;
+        writeBandwidth = 0.0;
+        standbyDriving = false;
+        iterationSeen = false;
+        failoverTime = 0.0;
+
+        statisticsCycles = 0u;
+        masterStepRetries = 0u;
+        lastCycleTicks = 0u;
+
+        lastGateIteration = 0;
+        uint32 h;
+        for (h = 0u; h < nOfHosts; h++) {
+            hostDue[h] = true;
+            hostFresh[h] = false;
+        }
+        writeTicksMax = 0u;
+        readTicksMax = 0u;
+        cycleTicksMax = 0u;
+
+        uint32 p;
+        for (p = 0u; p < 2u; p++) {
+            if (readPlans[p].inputBufferInternal != NULL) {
+                memset(readPlans[p].inputBufferInternal, 0, readPlans[p].inputBufferInternalSize);
+            }
+        }
+        uint32 w;
+        for (w = 0u; w < numberOfReadWindows; w++) {
+            memset(readWindows[w].windowBuffer, 0, readWindows[w].windowSize);
+        }
+        memset(pOutputBufferInternal, 0, outputsize + trailersize);
+        if (historydepth > 0u) {
+            memset(inputHistory, 0, historydepth * inputsize);
+            memset(historyCounters, 0, historydepth * sizeof(int32));
+            historyIndex = 0u;
+        }
+        stampedCounter = 0;
+        StampOutputTrailer(0);
 
         localCounter = 0u;
         counterEmbedded = 0;
         termmsgsent = false;
         counter = 0u;
 
-        if (!rfm_master_step(0, initruntime)) {
-            REPORT_ERROR(ErrorManagement::Warning, "Could not zero the RFM cycle counter");
+        //the replay restarts from the first recorded cycle, the card is not used
+        if (replaying) {
+            replayStarted = false;
+            if (!recorder.Rewind()) {
+                REPORT_ERROR(ErrorManagement::Warning, "Could not rewind the record file %s", replayfile.Buffer());
+            }
         }
         else {
-            REPORT_ERROR(ErrorManagement::Warning, "RFM cycle counter zeroed, RFM time set to %d", initruntime);
+            //all the slots restart from a zero counter
+            uint32 slot;
+            for (slot = 0u; slot < hostslots; slot++) {
+                RFM2G_UINT32 slotOffset = writeoffset + nodeIdNumber * trailersize + slot * (outputsize + trailersize);
+                if (simulatedcard)
+                    WriteRFM<true, false, false>(slotOffset, pOutputBufferInternal, outputsize + trailersize);
+                else if (usedma)
+                    RFM2gWriteDMAwaitfinish(rfmhandle, slotOffset, pOutputBufferInternal, outputsize + trailersize);
+                else
+                    RFM2gWriteDMA(rfmhandle, slotOffset, pOutputBufferInternal, outputsize + trailersize);
+            }
+            writeSlot = 0u;
+
+            if (!rfm_master_step(0, initruntime, timeBase.Now())) {
+                REPORT_ERROR(ErrorManagement::Warning, "Could not zero the RFM cycle counter");
+            }
+            else {
+                REPORT_ERROR(ErrorManagement::Warning, "RFM cycle counter zeroed, RFM time set to %d", initruntime);
+            }
+
+            //the master opens a new master epoch, a standby that was driving steps back when it sees it
+            if (master) {
+                if (!PublishMasterEpoch()) {
+                    REPORT_ERROR(ErrorManagement::Warning, "Could not publish the master epoch");
+                }
+            }
+        }
+
+        if (parked) {
+            parked = false;
+            (void) parkSem.Post();
+            REPORT_ERROR(ErrorManagement::Information, "Independent Thread released");
         }
     }
 
@@ -1027,46 +2028,88 @@ bool RFM2g::PrepareNextState(const char8 *const currentStateName,
 /*lint -e{715}  [MISRA C++ Rule 0-1-11], [MISRA C++ Rule 0-1-12]. Justification: the method sleeps for the given period irrespectively of the input info.*/
 ErrorManagement::ErrorType RFM2g::Execute(ExecutionInfo &info) {
 
-    ErrorManagement::ErrorType err = ErrorManagement::NoError;
-
     //while(1) {};
 
     if (!oktorun) {
         Sleep::NoMore(1);
     }
 
-    if (master) {
-        /* when called, update the RFM counter with the value
-         provided from the rt application
-         (usually a cycle counter coming from the main timing system)
-         */
+    //a parked thread only waits for the next Run
+    if (parked) {
+        threadParked = true;
+        if (!master && !replaying) {
+            WatchDiscoveryEpoch();
+        }
+        (void) parkSem.Wait(PARK_WAIT_MS);
+        return ErrorManagement::NoError;
+    }
+    threadParked = false;
+
+    //the cycle specialised for this configuration, selected once in Initialise
+    return (this->*cycleFunction)(info);
+}
 
-#ifdef _DEBUG
-                REPORT_ERROR(ErrorManagement::Information, "The master (nodeID= %d) is preparing itself for the writing", NodeId);
-#endif
+template<bool mapped, bool dma, bool waitDMA>
+ErrorManagement::ErrorType RFM2g::MasterCycle(ExecutionInfo &info) {
 
-        Write(info);
+    ErrorManagement::ErrorType err = ErrorManagement::NoError;
 
-#ifdef _DEBUG
-                REPORT_ERROR(ErrorManagement::Information, "The master has written");
-#endif
+    if (warmUpRemaining > 0u) {
+        WarmUp<mapped, dma, waitDMA>();
+    }
 
-        if (counterAndTimer[0] == 1) {
-            realTimeOffset = HighResolutionTimer::Counter();
-        }
+    /* when called, update the RFM counter with the value
+     provided from the rt application
+     (usually a cycle counter coming from the main timing system)
+     */
 
-        realTime = HighResolutionTimer::Period() * (HighResolutionTimer::Counter() - realTimeOffset);
+    //with MasterPacing the cycle starts on the absolute timeline, whenever Synchronise has been called
+    uint64 cycleStartTicks = 0u;
+    if (masterpacing) {
+        cycleStartTicks = PaceCycleStart();
+    }
 
-        uint16 stepretry = 0;
-        while (!rfm_master_step(counterAndTimer[0], counterAndTimer[1]) && stepretry < masterstepmaxretries) {
-            stepretry++;
-        }
+    if (faultsenabled) {
+        faults.BeginCycle(static_cast<uint32>(counterAndTimer[0]));
+    }
+
+    uint64 phaseTicks = HighResolutionTimer::Counter();
+    Write<mapped, dma, waitDMA>(info);
+    writeTicks = HighResolutionTimer::Counter() - phaseTicks;
+
+    if (masterpacing) {
+        WaitUntil(cycleStartTicks + pacingStepPhaseTicks);
+    }
+
+    timeBase.Refine();
+    uint64 nowNs = timeBase.Now();
+
+    if (counterAndTimer[0] == 1) {
+        realTimeOffset = nowNs;
+    }
 
-#ifdef _DEBUG
-                REPORT_ERROR(ErrorManagement::Information, "Master counter= %d", counterAndTimer[0]);
-#endif
+    realTime = static_cast<float64>(nowNs - realTimeOffset) * 1e-9;
 
-        // waiting
+    //the master clock is the ring time
+    ringTime = static_cast<float64>(nowNs) * 1e-9;
+
+    //a frozen master leaves the ring counter as it is, as a stalled master would
+    uint16 stepretry = 0;
+    bool frozen = faultsenabled && faults.Active(RFM2G_FAULT_FREEZE_MASTER);
+    while (!frozen && !rfm_master_step(counterAndTimer[0], counterAndTimer[1], nowNs) && stepretry < masterstepmaxretries) {
+        stepretry++;
+    }
+    masterStepRetries += stepretry;
+
+    if (logtrace) {
+        (void) logger.Log(RFM2G_LOG_TRACE_MASTER, counterAndTimer[0], stepretry);
+    }
+
+    // waiting
+    if (masterpacing) {
+        WaitUntil(cycleStartTicks + pacingReadPhaseTicks);
+    }
+    else {
         uint64 startTicksTimeOut = HighResolutionTimer::Counter();
 
         do {
@@ -1075,241 +2118,519 @@ ErrorManagement::ErrorType RFM2g::Execute(ExecutionInfo &info) {
 
         }
         while (((HighResolutionTimer::Counter() - startTicksTimeOut) < timeOutTicks));
+    }
 
-        //start the reading operations
-        Read(info);
+    //start the reading operations
+    phaseTicks = HighResolutionTimer::Counter();
+    Read<mapped, dma, waitDMA>(info);
+    readTicks = HighResolutionTimer::Counter() - phaseTicks;
 
-        //In case the master is not able to write its counter, a negative value will appear on the diagnostic channel
-        //Such negative value will be the difference counterAndTimer[0]-lastMasterIteration. It the lastMasterIteration cannot be get
-        //i.e., the get_iteration fails, then a default negative value (-12345) will be provided
-        if (stepretry >= masterstepmaxretries) {
-            diagnosticData[0] = -12345;  //default value in case it is not possible to read the iteration
+    DeadlineAccounting(nowNs);
 
-            int32 lastMasterIteration;
+    if (parametersenabled) {
+        ParameterUpdate<mapped>(counterAndTimer[0]);
+    }
 
-            if (get_iteration(rfmhandle, &lastMasterIteration)) {
-                diagnosticData[0] = counterAndTimer[0] - lastMasterIteration;
-            }
+    //In case the master is not able to write its counter, a negative value will appear on the diagnostic channel
+    //Such negative value will be the difference counterAndTimer[0]-lastMasterIteration. It the lastMasterIteration cannot be get
+    //i.e., the get_iteration fails, then a default negative value (-12345) will be provided
+    if (stepretry >= masterstepmaxretries) {
+        diagnosticData[0] = -12345;  //default value in case it is not possible to read the iteration
 
+        int32 lastMasterIteration;
+
+        if (get_iteration(rfmhandle, &lastMasterIteration)) {
+            diagnosticData[0] = counterAndTimer[0] - lastMasterIteration;
         }
 
-#ifdef _DEBUG
-                REPORT_ERROR(ErrorManagement::Information, "The master has red");
-#endif
+        (void) logger.Log(RFM2G_LOG_MASTER_STEP_FAILED, counterAndTimer[0], stepretry, static_cast<int32>(diagnosticData[0]));
+
     }
 
-    else {  //here starts the slave execute
+    PublishStatistics();
 
-        if (synchronising) {
+    return err;
+}
 
-            if (executionMode != RFM2G_EXEC_MODE_SPAWNED) {
-                err = ErrorManagement::NotCompleted;
-            }
+template<bool spawned, bool mapped, bool dma, bool waitDMA>
+ErrorManagement::ErrorType RFM2g::SlaveCycle(ExecutionInfo &info) {
 
-            bool notRunning = false;
+    ErrorManagement::ErrorType err = ErrorManagement::NoError;
 
-            //check if the counter is outside the maximum number of cycles
-            (void) fastMux.FastLock(TTInfiniteWait, 0.);
+    if (!spawned) {
+        err = ErrorManagement::NotCompleted;
+    }
 
-            if (counterAndTimer[0] + 1 > cycles) {
-                if (!termmsgsent) {
-                    ReferenceT < Message > termMessage = Get(0);
-                    if (termMessage.IsValid()) {
-                        REPORT_ERROR(ErrorManagement::Information, "Sending termination message");
-                        SendMessage(termMessage, this);
-                    }
-                    termmsgsent = true;
-                }
-                Sleep::Sec(1);
-                REPORT_ERROR(ErrorManagement::Information, "Max Number of cycles Reached");
+    bool notRunning = false;
+
+    if (warmUpRemaining > 0u) {
+        WarmUp<mapped, dma, waitDMA>();
+    }
+
+    //check if the counter is outside the maximum number of cycles
+    (void) fastMux.FastLock(TTInfiniteWait, 0.);
+    bool maxCyclesReached = (counterAndTimer[0] + 1 > cycles);
+    int32 lastCycle = counterAndTimer[0];
+    fastMux.FastUnLock();
+
+    //the lock is not held while waiting
+    if (maxCyclesReached) {
+        if (!termmsgsent) {
+            ReferenceT < Message > termMessage = Get(0);
+            if (termMessage.IsValid()) {
+                (void) logger.Log(RFM2G_LOG_TERMINATION_SENT, lastCycle);
+                __sync_synchronize();
+                termMessagePending = true;
             }
-            fastMux.FastUnLock();
+            termmsgsent = true;
+        }
+        (void) logger.Log(RFM2G_LOG_MAX_CYCLES, lastCycle);
+        //the cycles are over: as when parked, nothing is exchanged until the next Run, only the epoch is followed
+        WatchDiscoveryEpoch();
+        (void) parkSem.Wait(PARK_WAIT_MS);
+        return ErrorManagement::NoError;
+    }
 
 //in case of spawned thread, check if a termination message has been received
-            if (executionMode == RFM2G_EXEC_MODE_SPAWNED) {
-                EmbeddedThreadI::States status;
-                status = executor.GetStatus();
-                notRunning = (status != EmbeddedThreadI::RunningState);
-            }
+    if (spawned) {
+        EmbeddedThreadI::States status;
+        status = executor.GetStatus();
+        notRunning = (status != EmbeddedThreadI::RunningState);
+    }
 
-#ifdef _DEBUG
+// the slave gets the current iteration from the RFM
 
-            // This is a sleep in case the counter is still the old one (maybe better a normal sleep)
-                 Sleep::Sec(0.001);  //If not inserted, no standard output visible at runtime. Change here for appropriate sleep period
-#endif
+    uint64 elapsedTimeTicks = 0u;
+    uint64 startTicksTimeOut = HighResolutionTimer::Counter();
+    if (counter == 0)
+        realTimeOffset = timeBase.Now();
 
-// the slave gets the current iteration from the RFM
+    //a restarted master waits in its discovery for this host: the entry is stamped in its new epoch
+    WatchDiscoveryEpoch();
 
-            uint64 elapsedTimeTicks = 0u;
-            uint64 startTicksTimeOut = HighResolutionTimer::Counter();
-            if (counter == 0)
-                realTimeOffset = HighResolutionTimer::Counter();
+    //after a failover this node drives the ring counter at the master pace
+    if (standbyDriving && !notRunning) {
+        StandbyMasterStep();
+    }
 
-            while (!get_iteration(rfmhandle, &localcurrentcycle) && elapsedTimeTicks < timeOutTicks && !notRunning) {
+    while (!get_iteration(rfmhandle, &localcurrentcycle) && elapsedTimeTicks < timeOutTicks && !notRunning) {
 
-                elapsedTimeTicks = HighResolutionTimer::Counter() - startTicksTimeOut;
-            }
+        elapsedTimeTicks = HighResolutionTimer::Counter() - startTicksTimeOut;
+    }
 
-#ifdef _DEBUG
-            if (elapsedTimeTicks >= timeOutTicks && !notRunning) {
-                REPORT_ERROR(ErrorManagement::Information, "Slave %d cannot get the current cycle", nodeIdNumber);
-            }
+    //a stalled counter for failoverperiods master periods means the master is lost
+    if (standby && !notRunning) {
+        uint64 nowTicks = HighResolutionTimer::Counter();
+        if (!iterationSeen || (localcurrentcycle != lastSeenIteration)) {
+            lastIterationTicks = nowTicks;
+            iterationSeen = (localcurrentcycle != 0);
+        }
+        else if (!standbyDriving && (failoverTicks > 0u) && ((nowTicks - lastIterationTicks) > failoverTicks)) {
+            StandbyTakeOver(nowTicks);
+        }
+    }
 
-#endif
+    //a new master cycle seen while polling: the time of its detection is a ring time sample
+    uint64 detectionNs = timeBase.Now();
+    uint64 masterNs = 0u;
+    bool masterNsRead = false;
+    if (!notRunning && (localcurrentcycle != lastSeenIteration)) {
+        masterNsRead = ReadMasterRingTime(masterNs);
+        if (masterNsRead && (localcurrentcycle == lastSeenIteration + 1)) {
+            RingTimeSample(detectionNs, masterNs);
+        }
+    }
+    lastSeenIteration = localcurrentcycle;
 
-            /*
-             #ifdef _DEBUG
+    if (elapsedTimeTicks >= timeOutTicks && !notRunning) {
+        (void) logger.Log(RFM2G_LOG_NO_CURRENT_CYCLE, nodeIdNumber);
+    }
 
-             REPORT_ERROR(ErrorManagement::Information, "Counter received from the master= %d",localcurrentcycle);
-             REPORT_ERROR(ErrorManagement::Information, "Slave counter= %d",counterAndTimer[0]);
-             #endif
-             */
+    /*
+     #ifdef _DEBUG
 
-            if (localcurrentcycle > counter && !notRunning) {
+     REPORT_ERROR(ErrorManagement::Information, "Counter received from the master= %d",localcurrentcycle);
+     REPORT_ERROR(ErrorManagement::Information, "Slave counter= %d",counterAndTimer[0]);
+     #endif
+     */
 
-                localCounter += localcurrentcycle - counter;
-                counter = localcurrentcycle;
+    if (localcurrentcycle > counter && !notRunning) {
 
-#ifdef _DEBUG
+        localCounter += localcurrentcycle - counter;
+        counter = localcurrentcycle;
 
-                REPORT_ERROR(ErrorManagement::Information, "Slave counter= %d",counterAndTimer[0]);
-                REPORT_ERROR(ErrorManagement::Information, "Slave localCounter= %d",localCounter);
-#endif
+        if (logtrace) {
+            (void) logger.Log(RFM2G_LOG_TRACE_SLAVE, localcurrentcycle, counterAndTimer[0], static_cast<int32>(localCounter));
+        }
 
-                //this is the case when the slave must write/read (according to the downsample factor)
-                if (localCounter >= downsamplefactor) {
-                    realTime = (HighResolutionTimer::Counter() - realTimeOffset) * HighResolutionTimer::Period();
+        //this is the case when the slave must write/read (according to the downsample factor)
+        if (localCounter >= downsamplefactor) {
+            timeBase.Refine();
+            uint64 nowNs = timeBase.Now();
+            realTime = static_cast<float64>(nowNs - realTimeOffset) * 1e-9;
+            ringTime = ringTimeValid ? (static_cast<float64>(static_cast<int64>(nowNs) - ringTimeOffset) * 1e-9) : 0.0;
 
-                    (void) fastMuxRFM.FastLock(TTInfiniteWait, 0.);
+            (void) fastMuxRFM.FastLock(TTInfiniteWait, 0.);
 
-                    Write(info);
+            if (faultsenabled) {
+                faults.BeginCycle(static_cast<uint32>(counterAndTimer[0]));
+            }
 
-                   fastMuxRFM.FastUnLock();
+            uint64 phaseTicks = HighResolutionTimer::Counter();
+            Write<mapped, dma, waitDMA>(info);
+            writeTicks = HighResolutionTimer::Counter() - phaseTicks;
 
-#ifdef _DEBUG
+           fastMuxRFM.FastUnLock();
 
-                REPORT_ERROR(ErrorManagement::Information, "the slave has written");
+            counter = (localcurrentcycle / downsamplefactor) * downsamplefactor;
+            localCounter = 0u;
 
+            int32 previousCounterEmbedded = counterEmbedded;
+            counterEmbedded = counter / downsamplefactor;
 
-#endif
+            CycleLossAccounting(previousCounterEmbedded);
 
-                    counter = (localcurrentcycle / downsamplefactor) * downsamplefactor;
-                    localCounter = 0u;
+            startTicksTimeOut = HighResolutionTimer::Counter();
 
-                    counterEmbedded = counter / downsamplefactor;
+            do {
+                ;
+            }
+            while (HighResolutionTimer::Counter() - startTicksTimeOut < timeOutTicks && !notRunning);
 
-                    startTicksTimeOut = HighResolutionTimer::Counter();
+            PeekRFM32(RFM_TIME_OFFSET, (RFM2G_UINT32&) counterAndTimer[1]);
 
-                    do {
-                        ;
-                    }
-                    while (HighResolutionTimer::Counter() - startTicksTimeOut < timeOutTicks && !notRunning);
+            if (masterNodeSignalIdx != RFM2G_NO_SIGNAL) {
+                PeekRFM32(RFM_MASTER_NODE_OFFSET, masterNode);
+            }
 
-                    RFM2gPeek32(rfmhandle, RFM_TIME_OFFSET, (RFM2G_UINT32*) &(counterAndTimer[1]));
+           // (void) fastMuxRFM.FastLock(TTInfiniteWait, 0.);
+            phaseTicks = HighResolutionTimer::Counter();
+            Read<mapped, dma, waitDMA>(info);
+            readTicks = HighResolutionTimer::Counter() - phaseTicks;
 
-                   // (void) fastMuxRFM.FastLock(TTInfiniteWait, 0.);
-                    Read(info);
-                    //fastMuxRFM.FastUnLock();
-#ifdef _DEBUG
+            //the deadline runs from the master tick (in this clock), the detection is late by the polling and the ring latency
+            uint64 triggerNs = detectionNs;
+            if (ringTimeValid && masterNsRead) {
+                triggerNs = static_cast<uint64>(static_cast<int64>(masterNs) + ringTimeOffset);
+            }
+            DeadlineAccounting(triggerNs);
 
-                REPORT_ERROR(ErrorManagement::Information, "the slave has red");
+            if (parametersenabled) {
+                ParameterUpdate<mapped>(counter);
+            }
+            //fastMuxRFM.FastUnLock();
 
+            PublishStatistics();
 
-#endif
+            bool check_counter = (counter < startcycle);
 
-                    bool check_counter = (counter < startcycle);
+            if (logtrace && check_counter) {
+                (void) logger.Log(RFM2G_LOG_TRACE_START, counter, startcycle);
+            }
 
-#ifdef _DEBUG
- if (check_counter) {
- 
-                REPORT_ERROR(ErrorManagement::Information, "start time not reached yet");
-}
+            if (!check_counter) {
 
+                if (spawned) {
+                    err = !(synchSem.Post());
 
-#endif
+                }
 
-                    if (!check_counter) {
+                err = ErrorManagement::NoError;
 
-                        if (executionMode == RFM2G_EXEC_MODE_SPAWNED) {
-                            err = !(synchSem.Post());
+            }
 
-                        }
+        }
 
-                        err = ErrorManagement::NoError;
+    }
 
-                    }
+    return err;
+}
 
-                }
+template<bool mapped, bool dma, bool waitDMA>
+void RFM2g::WarmUp() {
 
+    //the plan is only used if already taken: the raw image read here is overwritten by the next Read
+    const HostReadPlan *plan = activePlan;
+
+    while (warmUpRemaining > 0u) {
+        //one cycle at a time: a BulkSend (or the bulk receiver) is not held off for all the warm-up
+        (void) fastMuxRFM.FastLock(TTInfiniteWait, 0.);
+        if (plan != NULL) {
+            uint32 t = 0u;
+            for (t = 0u; t < plan->numberOfTransfers; t++) {
+                ReadRFM<mapped, dma, waitDMA>(plan->transfers[t].transferOffset, plan->inputBufferInternal + plan->transfers[t].transferInternalOffset,
+                                              plan->transfers[t].transferSize);
             }
+        }
+        //the output is still the zeroed one written when entering Run
+        WriteRFM<mapped, dma, waitDMA>(writeoffset + nodeIdNumber * trailersize + writeSlot * (outputsize + trailersize), pOutputBufferInternal,
+                                       outputsize + trailersize);
+        fastMuxRFM.FastUnLock();
+        warmUpRemaining--;
+    }
 
-            else {
+}
+
+/*lint -e{715}  [MISRA C++ Rule 0-1-11], [MISRA C++ Rule 0-1-12]. Justification: the replay does not use the input info.*/
+ErrorManagement::ErrorType RFM2g::ReplayCycle(ExecutionInfo &info) {
+    return ReplayStep();
+}
 
-#ifdef _DEBUG
+template<bool mapped, bool dma, bool waitDMA>
+void RFM2g::SelectCycle() {
+    if (master) {
+        cycleFunction = &RFM2g::MasterCycle<mapped, dma, waitDMA>;
+    }
+    else if (executionMode == RFM2G_EXEC_MODE_SPAWNED) {
+        cycleFunction = &RFM2g::SlaveCycle<true, mapped, dma, waitDMA>;
+    }
+    else {
+        cycleFunction = &RFM2g::SlaveCycle<false, mapped, dma, waitDMA>;
+    }
+}
+
+void RFM2g::SelectCycle() {
+    if (replaying) {
+        cycleFunction = &RFM2g::ReplayCycle;
+    }
+    else if (rfmmapped) {
+        if (!usedma) {
+            SelectCycle<true, false, false>();
+        }
+        else if (waitdma) {
+            SelectCycle<true, true, true>();
+        }
+        else {
+            SelectCycle<true, true, false>();
+        }
+    }
+    else {
+        if (!usedma) {
+            SelectCycle<false, false, false>();
+        }
+        else if (waitdma) {
+            SelectCycle<false, true, true>();
+        }
+        else {
+            SelectCycle<false, true, false>();
+        }
+    }
 
-                Sleep::Sec(0.005);
+    REPORT_ERROR(ErrorManagement::Information, "Cycle: %s%s, %s%s%s", replaying ? "replay" : (master ? "master" : "slave"),
+                 (!master && (executionMode == RFM2G_EXEC_MODE_SPAWNED)) ? " (independent thread)" : "", rfmmapped ? "mapped " : "",
+                 usedma ? "DMA" : "PIO", (usedma && !waitdma) ? " not waited" : "");
+}
 
+template<bool mapped, bool dma, bool waitDMA>
+ErrorManagement::ErrorType RFM2g::Read(ExecutionInfo &info) {
 
-#endif
+    bool newPlan = TakePendingPlan();
 
-            }
+    if (activePlan != NULL) {
+        const HostReadPlan &plan = *activePlan;
 
+        uint32 i = 0u;
+
+        //the slot is selected on the counters before its payload is transferred
+        if (hostslots == 2u) {
+            SelectHostSlots(plan);
         }
 
+        if (freshnessgate) {
+            //a new plan may have moved the hosts in the internal buffer: all of them are read again
+            if (newPlan) {
+                for (i = 0u; i < nOfHosts; i++) {
+                    hostDue[i] = true;
+                    counterRead[i] = 0;
+                }
+            }
+
+            GateFreshHosts(plan);
+
+            for (i = 0u; i < plan.numberOfHostsToRead; i++) {
+                uint32 host = plan.hostsToRead[i];
+                if (hostFresh[host]) {
+                    const HostReadMappingInfo &hostInfo = plan.hostsToReadInfo[host];
+                    uint32 t = 0u;
+                    for (t = hostInfo.hostFirstTransfer; t < hostInfo.hostFirstTransfer + hostInfo.hostNumberOfTransfers; t++) {
+                        ReadRFM<mapped, dma, waitDMA>(plan.transfers[t].transferOffset, plan.inputBufferInternal + plan.transfers[t].transferInternalOffset,
+                                plan.transfers[t].transferSize);
+                        bytesRead += plan.transfers[t].transferSize;
+                    }
+                }
+            }
+        }
         else {
-            // TODO: implement a not synchronizing (calling thread side) (node07 and node08 example)
-            // spawned data exchange with the RFM
+            for (i = 0u; i < plan.numberOfTransfers; i++) {
+                ReadRFM<mapped, dma, waitDMA>(plan.transfers[i].transferOffset, plan.inputBufferInternal + plan.transfers[i].transferInternalOffset, plan.transfers[i].transferSize);
+            }
+            bytesRead += plan.readBytesPerCycle;
+        }
+
+// TODO: how to handle an error here (RT phase) ?
+
+        //the raw image is recorded before the remapping, the replay remaps it with the recorded table
+        if (recording) {
+            int32 recordCounter = master ? counterAndTimer[0] : counterEmbedded;
+            uint64 recordNs = timeBase.Now();
+            if (newPlan) {
+                (void) recorder.Record(RFM2G_RECORD_TABLE, recordCounter, counterAndTimer[1], recordNs, plan.hostsProtocolInfo,
+                                       nOfHosts * SIZE_OF_HOST_PROTOCOL_DATA);
+            }
+            (void) recorder.Record(RFM2G_RECORD_IMAGE, recordCounter, counterAndTimer[1], recordNs, plan.inputBufferInternal, plan.inputsizeRemapped);
         }
+
+        readRemapping(plan, true);
+        EvaluateDiagnostcData(plan);
+        PushHistory(master ? counterAndTimer[0] : counterEmbedded);
     }
 
-    return err;
+    return ErrorManagement::NoError;
+
 }
 
-ErrorManagement::ErrorType RFM2g::Read(ExecutionInfo &info) {
+bool RFM2g::TakePendingPlan() {
 
-    if (!usedma) {
-        RFM2gRead(rfmhandle, hostsToReadInfo[initialHostToRead].hostToReadOffset, pInputBufferInternal, inputsizeRemapped);
+    //the plan published by SettingDiagnosticProtocol is taken at the cycle boundary, without locks nor allocations
+    HostReadPlan *nextPlan = __sync_lock_test_and_set(&pendingPlan, NULL_PTR(HostReadPlan*));
+    if (nextPlan != NULL) {
+        activePlan = nextPlan;
+    }
+
+    return (nextPlan != NULL);
+}
 
+ErrorManagement::ErrorType RFM2g::ReplayStep() {
+
+    ErrorManagement::ErrorType err = ErrorManagement::NoError;
+
+    RFM2gRecordFrame frame;
+    bool ok = true;
+    bool imageRead = false;
+
+    //the recorded tables rebuild the read plans, offline the plan can be built in this thread
+    while (ok && !imageRead) {
+        ok = recorder.NextFrame(frame);
+        if (ok && (frame.type == RFM2G_RECORD_TABLE)) {
+            replayTableValid = recorder.ReadPayload(frame, replayTable, nOfHosts * SIZE_OF_HOST_PROTOCOL_DATA);
+            ok = replayTableValid;
+            if (ok) {
+                ok = !SettingDiagnosticProtocol().fatalError;
+            }
+        }
+        else if (ok && (frame.type == RFM2G_RECORD_IMAGE)) {
+            (void) TakePendingPlan();
+            ok = (activePlan != NULL);
+            if (ok) {
+                ok = (frame.size == activePlan->inputsizeRemapped);
+            }
+            if (ok) {
+                ok = recorder.ReadPayload(frame, activePlan->inputBufferInternal, activePlan->inputBufferInternalSize);
+            }
+            if (!ok) {
+                REPORT_ERROR(ErrorManagement::FatalError, "The recorded cycle %d does not match the read plan of this node", frame.counter);
+            }
+            imageRead = ok;
+        }
+        else if (ok) {
+            (void) recorder.ReadPayload(frame, NULL_PTR(void*), 0u);
+        }
     }
-    else {
-        if (waitdma) {
 
-            RFM2gReadDMAwaitfinish(rfmhandle, hostsToReadInfo[initialHostToRead].hostToReadOffset, pInputBufferInternal, inputsizeRemapped);
+    if (imageRead) {
+        if (!replayStarted) {
+            replayFirstNs = frame.timestampNs;
+            replayStartNs = timeBase.Now();
+            replayStarted = true;
+        }
+        else if (replaypaced) {
+            uint64 targetNs = replayStartNs + (frame.timestampNs - replayFirstNs);
+            while (timeBase.Now() < targetNs) {
+                ;
+            }
+        }
 
+        realTime = static_cast<float64>(frame.timestampNs - replayFirstNs) * 1e-9;
+        counterAndTimer[1] = frame.time;
+        if (master) {
+            counterAndTimer[0] = frame.counter;
         }
         else {
+            (void) fastMux.FastLock(TTInfiniteWait, 0.);
+            counterEmbedded = frame.counter;
+            fastMux.FastUnLock();
+        }
 
-            RFM2gReadDMA(rfmhandle, hostsToReadInfo[initialHostToRead].hostToReadOffset, pInputBufferInternal, inputsizeRemapped);
-
+        //the recorded image is complete, all the hosts are remapped
+        if (freshnessgate) {
+            uint32 h;
+            for (h = 0u; h < nOfHosts; h++) {
+                hostFresh[h] = true;
+            }
         }
-    }
-// TODO: how to handle an error here (RT phase) ?
 
-    readRemapping();
-    EvaluateDiagnostcData();
+        readRemapping(*activePlan, false);
+        EvaluateDiagnostcData(*activePlan);
+        PushHistory(frame.counter);
 
-    return ErrorManagement::NoError;
+        PublishStatistics();
+
+        if (!master && (executionMode == RFM2G_EXEC_MODE_SPAWNED)) {
+            (void) synchSem.Post();
+        }
+    }
+    else {
+        //end of the record: the inputs are frozen at the last cycle
+        if (!termmsgsent) {
+            REPORT_ERROR(ErrorManagement::Information, "Replay of %s completed", replayfile.Buffer());
+            ReferenceT < Message > termMessage = Get(0);
+            if (termMessage.IsValid()) {
+                __sync_synchronize();
+                termMessagePending = true;
+            }
+            termmsgsent = true;
+        }
+        Sleep::Sec(0.001);
+    }
 
+    return err;
 }
 
+template<bool mapped, bool dma, bool waitDMA>
 ErrorManagement::ErrorType RFM2g::Write(ExecutionInfo &info) {
 
+    bool dropped = false;
+
+    if (faultsenabled) {
+        faults.Delay(RFM2G_FAULT_WRITE_LATENCY);
+        dropped = faults.Active(RFM2G_FAULT_DROP_WRITE);
+    }
+
     MemoryOperationsHelper::Copy(pOutputBufferInternal, pOutputBuffer, outputsize);
 
-    int32 *ptCounter = (int32*) ((uint8*) pOutputBufferInternal + outputsize);
+    if (!(faultsenabled && faults.Active(RFM2G_FAULT_STALE_COUNTER))) {
+        stampedCounter = counterAndTimer[0];
+    }
 
-    *ptCounter = counterAndTimer[0];
+    StampOutputTrailer(stampedCounter);
 
-    if (!usedma) {
-        RFM2gWrite(rfmhandle, writeoffset + nodeIdNumber * sizeof(int32), pOutputBufferInternal, outputsize + sizeof(int32));
+    //the CRC, if any, is left as it is: the readers see a corrupted segment
+    if (faultsenabled && faults.Active(RFM2G_FAULT_CORRUPT_COUNTER)) {
+        int32 *ptCounter = (int32*) ((uint8*) pOutputBufferInternal + outputsize);
+        *ptCounter = ~(*ptCounter);
     }
-    else {
-        if (waitdma) {
-            RFM2gWriteDMAwaitfinish(rfmhandle, writeoffset + nodeIdNumber * sizeof(int32), pOutputBufferInternal, outputsize + sizeof(int32));
-        }
-        else {
-            RFM2gWriteDMA(rfmhandle, writeoffset + nodeIdNumber * sizeof(int32), pOutputBufferInternal, outputsize + sizeof(int32));
-        }
+
+    //with PingPongSlots the slot of the last completed write is left untouched
+    if (!dropped) {
+        WriteRFM<mapped, dma, waitDMA>(writeoffset + nodeIdNumber * trailersize + writeSlot * (outputsize + trailersize), pOutputBufferInternal,
+                                       outputsize + trailersize);
+        writeSlot = (writeSlot + 1u) % hostslots;
+        bytesWritten += outputsize + trailersize;
+    }
+
+    //the bulk blob is sent after the cycle data, a fragment per cycle
+    if (bulkTxPending) {
+        BulkSendFragment<mapped>();
     }
 
 // TODO: how to handle an error here (RT phase) ?
@@ -1327,21 +2648,21 @@ uint32 RFM2g::GetStackSize() const {
 
 inline bool RFM2g::get_iteration(RFM2GHANDLE handle,
                                  int32 *current_iteration) {
-    unsigned char trig1 = 0;
-    unsigned char trig2 = 0;
+    uint8 trig1 = 0;
+    uint8 trig2 = 0;
 
 // first check ready to read  is OK
-    RFM2gPeek8(handle, RFM_TRIG_OFFSET, &trig1);
-    if (trig1 && 0x1) {
+    PeekRFM8(RFM_TRIG_OFFSET, trig1);
+    if ((trig1 & 0x1u) != 0u) {
 // OK to read
-        RFM2gPeek32(handle, RFM_ITERATION_OFFSET, (RFM2G_UINT32*) current_iteration);
+        PeekRFM32(RFM_ITERATION_OFFSET, *((RFM2G_UINT32*) current_iteration));
 
 //RFM2gPeek32(handle, RFM_TIME_OFFSET,(int32 *)currenttime);
 
 // verify that the flag did not change as we were reading
-        RFM2gPeek8(handle, RFM_TRIG_OFFSET, &trig2);
+        PeekRFM8(RFM_TRIG_OFFSET, trig2);
 
-        if (trig2 && 0x0) {
+        if ((trig2 & 0x1u) == 0u) {
             return false;  //flag went low during read. return not ok.
         }
         else {
@@ -1356,33 +2677,37 @@ inline bool RFM2g::get_iteration(RFM2GHANDLE handle,
 }
 
 bool RFM2g::rfm_master_step(int32 rfm_iter,
-                            int32 time) {
-    unsigned char trig = 0;
-    int result;
+                            int32 time,
+                            uint64 ringTimeNs) {
+    uint8 trig = 0;
 
 //
 // use blocking flags to prevent collision in read/write with iteration number
 // TODO: retry if trig booked ?
-    result = RFM2gPoke8(rfmhandle, RFM_TRIG_OFFSET, trig);
-    if (result != RFM2G_SUCCESS) {
+    if (!PokeRFM8(RFM_TRIG_OFFSET, trig)) {
         return false;
     }
 
 // increment the counter.
-    result = RFM2gWrite(rfmhandle, RFM_ITERATION_OFFSET, &rfm_iter, sizeof(int));
-    if (result != RFM2G_SUCCESS) {
+    if (!PokeRFM32(RFM_ITERATION_OFFSET, static_cast<RFM2G_UINT32>(rfm_iter))) {
         return false;
     }
 
 // increment the time.
-    result = RFM2gWrite(rfmhandle, RFM_TIME_OFFSET, &time, sizeof(int));
-    if (result != RFM2G_SUCCESS) {
+    if (!PokeRFM32(RFM_TIME_OFFSET, static_cast<RFM2G_UINT32>(time))) {
+        return false;
+    }
+
+// the master clock, read by the slaves to estimate their offset
+    if (!PokeRFM32(RFM_RING_TIME_OFFSET, static_cast<RFM2G_UINT32>(ringTimeNs))) {
+        return false;
+    }
+    if (!PokeRFM32(RFM_RING_TIME_OFFSET + sizeof(uint32), static_cast<RFM2G_UINT32>(ringTimeNs >> 32u))) {
         return false;
     }
 
     trig = 1;
-    result = RFM2gPoke8(rfmhandle, RFM_TRIG_OFFSET, trig);
-    if (result != RFM2G_SUCCESS) {
+    if (!PokeRFM8(RFM_TRIG_OFFSET, trig)) {
         return false;
     }
 
@@ -1393,453 +2718,2594 @@ bool RFM2g::rfm_master_step(int32 rfm_iter,
     return true;
 }
 
-ErrorManagement::ErrorType RFM2g::StopLLC() {
-    oktorun = false;
-    return ErrorManagement::NoError;
+/*
+ * The mapped RFM memory is uncached, volatile accesses go straight to the card.
+ * The barriers order the stores (i.e. the trigger flag after the counter) and
+ * prevent loads from being satisfied before the previous stores are visible.
+ */
+inline bool RFM2g::PeekRFM8(RFM2G_UINT32 offset,
+                            uint8 &value) {
+    bool ok = true;
+    if (rfmmapped) {
+        __sync_synchronize();
+        value = pRfmMemory[offset];
+    }
+    else {
+        ok = (RFM2gPeek8(rfmhandle, offset, &value) == RFM2G_SUCCESS);
+    }
+    return ok;
 }
 
-bool RFM2g::SetDiagnosticOwnData() {
+inline bool RFM2g::PeekRFM32(RFM2G_UINT32 offset,
+                             RFM2G_UINT32 &value) {
+    bool ok = true;
+    if (rfmmapped) {
+        __sync_synchronize();
+        value = *(reinterpret_cast<volatile RFM2G_UINT32*>(pRfmMemory + offset));
+    }
+    else {
+        ok = (RFM2gPeek32(rfmhandle, offset, &value) == RFM2G_SUCCESS);
+    }
+    return ok;
+}
 
-    //here the host put its data on the RFM so as to implement the counter diagnostic protocol
+inline bool RFM2g::PokeRFM8(RFM2G_UINT32 offset,
+                            uint8 value) {
+    bool ok = true;
+    if (rfmmapped) {
+        pRfmMemory[offset] = value;
+        __sync_synchronize();
+    }
+    else {
+        ok = (RFM2gPoke8(rfmhandle, offset, value) == RFM2G_SUCCESS);
+    }
+    return ok;
+}
+
+inline bool RFM2g::PokeRFM32(RFM2G_UINT32 offset,
+                             RFM2G_UINT32 value) {
+    bool ok = true;
+    if (rfmmapped) {
+        *(reinterpret_cast<volatile RFM2G_UINT32*>(pRfmMemory + offset)) = value;
+        __sync_synchronize();
+    }
+    else {
+        ok = (RFM2gPoke32(rfmhandle, offset, value) == RFM2G_SUCCESS);
+    }
+    return ok;
+}
+
+template<bool mapped, bool dma, bool waitDMA>
+inline bool RFM2g::ReadRFM(RFM2G_UINT32 offset,
+                           void *buffer,
+                           RFM2G_UINT32 size) {
+    RFM2G_STATUS result = RFM2G_SUCCESS;
+    if (mapped && (!dma || (size < dmathreshold))) {
+        __sync_synchronize();
+        MemoryOperationsHelper::Copy(buffer, (const void*) (pRfmMemory + offset), size);
+    }
+    else if (!dma) {
+        result = RFM2gRead(rfmhandle, offset, buffer, size);
+    }
+    else if (waitDMA) {
+        result = RFM2gReadDMAwaitfinish(rfmhandle, offset, buffer, size);
+        if (faultsenabled) {
+            faults.Delay(RFM2G_FAULT_DMA_DELAY);
+        }
+    }
+    else {
+        result = RFM2gReadDMA(rfmhandle, offset, buffer, size);
+        if (faultsenabled) {
+            faults.Delay(RFM2G_FAULT_DMA_DELAY);
+        }
+    }
+    return (result == RFM2G_SUCCESS);
+}
+
+/*
+ * On the mapped memory the trailing 32 bit word (the host counter, or its CRC
+ * when IntegrityCheck=1) is stored last, so that a reader never sees a new
+ * counter before its payload.
+ */
+template<bool mapped, bool dma, bool waitDMA>
+inline bool RFM2g::WriteRFM(RFM2G_UINT32 offset,
+                            void *buffer,
+                            RFM2G_UINT32 size) {
+    RFM2G_STATUS result = RFM2G_SUCCESS;
+    if (mapped && (!dma || (size < dmathreshold)) && (size >= sizeof(RFM2G_UINT32))) {
+        RFM2G_UINT32 payloadSize = size - static_cast<RFM2G_UINT32>(sizeof(RFM2G_UINT32));
+        MemoryOperationsHelper::Copy((void*) (pRfmMemory + offset), buffer, payloadSize);
+        __sync_synchronize();
+        *(reinterpret_cast<volatile RFM2G_UINT32*>(pRfmMemory + offset + payloadSize)) = *(reinterpret_cast<RFM2G_UINT32*>((uint8*) buffer + payloadSize));
+        __sync_synchronize();
+    }
+    else if (!dma) {
+        result = RFM2gWrite(rfmhandle, offset, buffer, size);
+    }
+    else if (waitDMA) {
+        result = RFM2gWriteDMAwaitfinish(rfmhandle, offset, buffer, size);
+        if (faultsenabled) {
+            faults.Delay(RFM2G_FAULT_DMA_DELAY);
+        }
+    }
+    else {
+        result = RFM2gWriteDMA(rfmhandle, offset, buffer, size);
+        if (faultsenabled) {
+            faults.Delay(RFM2G_FAULT_DMA_DELAY);
+        }
+    }
+    return (result == RFM2G_SUCCESS);
+}
+
+inline void RFM2g::StampOutputTrailer(const int32 hostCounter) {
+    int32 *ptCounter = (int32*) ((uint8*) pOutputBufferInternal + outputsize);
+
+    *ptCounter = hostCounter;
+
+    if (integritycheck) {
+        uint32 *ptCRC = (uint32*) (ptCounter + 1);
+        *ptCRC = RFM2gCRC32C::Compute(pOutputBufferInternal, outputsize + sizeof(int32));
+    }
+}
+
+/*
+ * The fragments are written with programmed IO: the blob is not in the DMA buffer.
+ * The bytes written are rounded up to words (the region capacity is a multiple of 4),
+ * so that on the mapped memory the last word is stored last as for the cycle data.
+ */
+template<bool mapped>
+void RFM2g::BulkSendFragment() {
+    RFM2G_UINT32 region = bulkoffset + nodeIdNumber * bulksize;
+
+    //a new blob: bytesWritten, size and CRC before the new identifier
+    if (bulkTxSent == 0u) {
+        bulkTxFragments = 0u;
+        (void) PokeRFM32(region + RFM2G_BULK_BYTES_WRITTEN_OFFSET, 0u);
+        (void) PokeRFM32(region + RFM2G_BULK_TOTAL_SIZE_OFFSET, bulkTxSize);
+        (void) PokeRFM32(region + RFM2G_BULK_CRC_OFFSET, bulkTxCRC);
+        (void) PokeRFM32(region + RFM2G_BULK_FRAGMENTS_OFFSET, 0u);
+        (void) PokeRFM32(region + RFM2G_BULK_BLOB_ID_OFFSET, bulkTxId);
+    }
+
+    uint32 remaining = bulkTxSize - bulkTxSent;
+    uint32 fragment = (remaining < bulkbytespercycle) ? remaining : bulkbytespercycle;
+    uint32 words = (fragment + 3u) & ~3u;
+    if (words > 0u) {
+        (void) WriteRFM<mapped, false, false>(region + static_cast<RFM2G_UINT32>(sizeof(RFM2gBulkHeader)) + bulkTxSent, bulkTxBuffer + bulkTxSent,
+                                              words);
+    }
+    bulkTxSent += fragment;
+    bulkTxFragments++;
+    bytesWritten += words;
+
+    (void) PokeRFM32(region + RFM2G_BULK_BYTES_WRITTEN_OFFSET, bulkTxSent);
+    (void) PokeRFM32(region + RFM2G_BULK_FRAGMENTS_OFFSET, bulkTxFragments);
+
+    if (bulkTxSent == bulkTxSize) {
+        __sync_synchronize();
+        bulkTxPending = false;
+    }
+}
+
+bool RFM2g::PublishMasterEpoch() {
+
+    RFM2G_UINT32 epoch = 0u;
+    bool ok = PeekRFM32(RFM_MASTER_EPOCH_OFFSET, epoch);
+
+    //the node first, the epoch last: a reader that sees the new epoch sees the new node
+    if (ok) {
+        ok = PokeRFM32(RFM_MASTER_NODE_OFFSET, nodeIdNumber);
+    }
+    if (ok) {
+        masterEpoch = epoch + 1u;
+        ok = PokeRFM32(RFM_MASTER_EPOCH_OFFSET, masterEpoch);
+    }
+    if (ok) {
+        masterNode = nodeIdNumber;
+        (void) logger.Log(RFM2G_LOG_MASTER_EPOCH, masterEpoch, nodeIdNumber);
+    }
+
+    return ok;
+
+}
+
+void RFM2g::StandbyTakeOver(const uint64 nowTicks) {
+
+    drivingIteration = lastSeenIteration;
+    drivingTime = static_cast<float64>(counterAndTimer[1]);
+    nextStepTicks = nowTicks;
+
+    //the ring time continues from the last one written by the lost master
+    RFM2G_UINT32 high = 0u;
+    RFM2G_UINT32 low = 0u;
+    bool ringTimeOk = PeekRFM32(RFM_RING_TIME_OFFSET + sizeof(uint32), high);
+    ringTimeOk = ringTimeOk && PeekRFM32(RFM_RING_TIME_OFFSET, low);
+    drivingRingNs = (static_cast<uint64>(high) << 32u) | static_cast<uint64>(low);
+    if (!ringTimeOk || (drivingRingNs == 0u)) {
+        drivingRingNs = timeBase.Now();
+    }
+
+    standbyDriving = PublishMasterEpoch();
 
-    bool ok, ok1, ok2, ok3;
-    ok = false;
+    //the failover time is measured from the last cycle of the lost master
+    failoverTime = static_cast<float64>(HighResolutionTimer::Counter() - lastIterationTicks) * HighResolutionTimer::Period();
 
-    RFM2G_STATUS result;
+    if (standbyDriving) {
+        (void) logger.Log(RFM2G_LOG_TAKEOVER, lastSeenIteration, nodeIdNumber, 0, failoverTime);
+        StandbyMasterStep();
+    }
+    else {
+        (void) logger.Log(RFM2G_LOG_TAKEOVER_FAILED, lastSeenIteration, nodeIdNumber);
+    }
+
+}
+
+void RFM2g::StandbyMasterStep() {
+
+    //the steps are on an absolute timeline: the pace does not depend on when the cycle calls this
+    WaitUntil(nextStepTicks);
+    uint64 nowTicks = HighResolutionTimer::Counter();
+
+    //a newer master epoch means that another node (e.g. the restarted master) drives the ring
+    RFM2G_UINT32 epoch = masterEpoch;
+    if (PeekRFM32(RFM_MASTER_EPOCH_OFFSET, epoch) && (epoch != masterEpoch)) {
+        standbyDriving = false;
+        lastIterationTicks = nowTicks;
+        (void) logger.Log(RFM2G_LOG_STANDBY_AGAIN, epoch, nodeIdNumber);
+    }
+    else {
+        drivingIteration++;
+        drivingTime += masterPeriodUs;
+        drivingRingNs += masterPeriodNs;
+
+        uint16 stepretry = 0;
+        while (!rfm_master_step(drivingIteration, static_cast<int32>(drivingTime), drivingRingNs) && stepretry < masterstepmaxretries) {
+            stepretry++;
+        }
+        masterStepRetries += stepretry;
+
+        nextStepTicks += masterPeriodTicks;
+        //the steps already past are skipped rather than burst, the timelines are kept
+        if (nowTicks >= (nextStepTicks + masterPeriodTicks)) {
+            uint64 late = (nowTicks - nextStepTicks) / masterPeriodTicks;
+            nextStepTicks += late * masterPeriodTicks;
+            drivingTime += static_cast<float64>(late) * masterPeriodUs;
+            drivingRingNs += late * masterPeriodNs;
+        }
+    }
+
+}
+
+void RFM2g::WatchDiscoveryEpoch() {
+
+    uint64 nowTicks = HighResolutionTimer::Counter();
+
+    if (nowTicks >= discoveryWatchTicks) {
+        discoveryWatchTicks = nowTicks + (static_cast<uint64>(DISCOVERY_WATCH_MS) * HighResolutionTimer::Frequency()) / 1000u;
+
+        RFM2G_UINT32 ringEpoch = 0u;
+        bool ok = PeekRFM32(RFM_DISCOVERY_EPOCH_OFFSET, ringEpoch);
+        bool ringOpen = ok && (ringEpoch != 0u) && ((ringEpoch & RFM_DISCOVERY_CLOSED) == 0u);
+
+        if (ringOpen && (ringEpoch != discoveryepoch)) {
+            (void) fastMuxRFM.FastLock(TTInfiniteWait, 0.);
+            ok = StampDiagnosticOwnData(ringEpoch);
+            fastMuxRFM.FastUnLock();
+            if (ok) {
+                (void) logger.Log(RFM2G_LOG_EPOCH_JOINED, static_cast<int32>(ringEpoch), nodeIdNumber);
+            }
+        }
+    }
+
+}
+
+bool RFM2g::ReadMasterRingTime(uint64 &masterNs) {
+
+    //the two words are read again if the master has changed the high word in between
+    RFM2G_UINT32 high1 = 0u;
+    RFM2G_UINT32 high2 = 0u;
+    RFM2G_UINT32 low = 0u;
+    bool ok = PeekRFM32(RFM_RING_TIME_OFFSET + sizeof(uint32), high1);
+    ok = ok && PeekRFM32(RFM_RING_TIME_OFFSET, low);
+    ok = ok && PeekRFM32(RFM_RING_TIME_OFFSET + sizeof(uint32), high2);
+
+    ok = ok && (high1 == high2) && ((high1 != 0u) || (low != 0u));
+    if (ok) {
+        masterNs = (static_cast<uint64>(high1) << 32u) | static_cast<uint64>(low);
+    }
+    return ok;
+}
+
+void RFM2g::RingTimeSample(const uint64 detectionNs,
+                           const uint64 masterNs) {
+
+    //the delay from the master write to the detection is always positive: its minimum over a window is the offset
+    int64 sample = static_cast<int64>(detectionNs) - static_cast<int64>(masterNs) - ringtimelatency;
+    if ((ringTimeSamples == 0u) || (sample < ringTimeWindowMin)) {
+        ringTimeWindowMin = sample;
+    }
+    ringTimeSamples++;
+
+    if (ringTimeSamples >= ringtimewindow) {
+        if (!ringTimeValid) {
+            ringTimeOffset = ringTimeWindowMin;
+            ringTimeValid = true;
+        }
+        else {
+            //smoothed, a single window with a long delay does not jump the ring time
+            ringTimeOffset += (ringTimeWindowMin - ringTimeOffset) / 4;
+        }
+        ringTimeSamples = 0u;
+    }
+
+}
+
+void RFM2g::CycleLossAccounting(const int32 previousCounterEmbedded) {
+
+    //the first cycle after the start has no reference
+    uint32 lost = 0u;
+    if (cycleLossArmed && (counterEmbedded > previousCounterEmbedded + 1)) {
+        lost = static_cast<uint32>(counterEmbedded - previousCounterEmbedded - 1);
+    }
+    cycleLossArmed = true;
+
+    skippedCycles = lost * downsamplefactor;
+
+    if (lost > 0u) {
+        lostCycles += lost;
+        lossEvents++;
+        consecutiveLosses++;
+    }
+    else {
+        consecutiveLosses = 0u;
+    }
+
+    if ((lost > 0u) && (catchuppolicy == RFM2G_CATCHUP_REPLAY)) {
+        //the lost cycles (at most catchupmaxreplay) and then the latest one are run by Synchronise
+        uint32 replayed = (lost < catchupmaxreplay) ? lost : catchupmaxreplay;
+        (void) fastMux.FastLock(TTInfiniteWait, 0.);
+        replayCycles = replayed + 1u;
+        fastMux.FastUnLock();
+    }
+
+    if ((catchuppolicy == RFM2G_CATCHUP_NOTIFY) && (consecutiveLosses >= catchupnotifyafter)) {
+        (void) logger.Log(RFM2G_LOG_CYCLE_LOSSES, consecutiveLosses, lostCycles);
+        __sync_synchronize();
+        lossMessagePending = true;
+        consecutiveLosses = 0u;
+    }
+
+}
+
+ErrorManagement::ErrorType RFM2g::StopLLC() {
+    oktorun = false;
+    return ErrorManagement::NoError;
+}
+
+bool RFM2g::SendBulk(const void * const blob,
+                     const uint32 size) {
+    bool ok = bulkenabled && (!bulkTxPending) && (size <= BulkCapacity());
+    if (ok) {
+        //the padding up to the word is sent as well
+        MemoryOperationsHelper::Set(bulkTxBuffer, '\0', BulkCapacity());
+        MemoryOperationsHelper::Copy(bulkTxBuffer, blob, size);
+        bulkTxSize = size;
+        bulkTxSent = 0u;
+        bulkTxCRC = RFM2gCRC32C::Compute(bulkTxBuffer, size);
+        bulkTxId++;
+        if (bulkTxId == 0u) {
+            bulkTxId = 1u;
+        }
+        //the blob is complete before the RT thread sees it
+        __sync_synchronize();
+        bulkTxPending = true;
+    }
+    return ok;
+}
+
+ErrorManagement::ErrorType RFM2g::SendBulkFile(StreamString fileName) {
+    ErrorManagement::ErrorType err = ErrorManagement::NoError;
+
+    if (!bulkenabled) {
+        REPORT_ERROR(ErrorManagement::IllegalOperation, "The bulk channel is not configured");
+        err = ErrorManagement::IllegalOperation;
+    }
+
+    FILE *file = static_cast<FILE*>(NULL);
+    if (err.ErrorsCleared()) {
+        file = fopen(fileName.Buffer(), "rb");
+        if (file == NULL) {
+            REPORT_ERROR(ErrorManagement::OSError, "Could not open %s", fileName.Buffer());
+            err = ErrorManagement::OSError;
+        }
+    }
+
+    if (err.ErrorsCleared()) {
+        //one byte more than the capacity to detect a file too large
+        uint8 *blob = new uint8[BulkCapacity() + 1u];
+        size_t size = fread(blob, 1u, BulkCapacity() + 1u, file);
+        if (size > BulkCapacity()) {
+            REPORT_ERROR(ErrorManagement::ParametersError, "%s is larger than the bulk region (%d bytes)", fileName.Buffer(), BulkCapacity());
+            err = ErrorManagement::ParametersError;
+        }
+        else if (!SendBulk(blob, static_cast<uint32>(size))) {
+            REPORT_ERROR(ErrorManagement::Timeout, "The previous bulk blob is still being sent");
+            err = ErrorManagement::Timeout;
+        }
+        else {
+            REPORT_ERROR(ErrorManagement::Information, "Sending %s (%d bytes) as bulk blob %d", fileName.Buffer(), static_cast<uint32>(size), bulkTxId);
+        }
+        delete[] blob;
+        (void) fclose(file);
+    }
+
+    return err;
+}
+
+bool RFM2g::GetBulk(const uint32 host,
+                    void * const buffer,
+                    const uint32 bufferSize,
+                    uint32 &size,
+                    uint32 &blobId) {
+    bool ok = bulkenabled && (host < nOfHosts);
+    if (ok) {
+        ok = (bulkMux.FastLock() == ErrorManagement::NoError);
+    }
+    if (ok) {
+        size = bulkRx[host].completeSize;
+        blobId = bulkRx[host].completeId;
+        ok = (size <= bufferSize);
+        if (ok) {
+            MemoryOperationsHelper::Copy(buffer, bulkRxComplete + host * BulkCapacity(), size);
+        }
+        bulkMux.FastUnLock();
+    }
+    return ok;
+}
+
+bool RFM2g::SetDiagnosticOwnData() {
+
+    //here the host put its data on the RFM so as to implement the counter diagnostic protocol
+
+    bool ok = true;
+
+    RFM2G_UINT32 ringEpoch = 0u;
+
+    if (master) {
+        //the master opens a new discovery epoch, the entries stamped with the previous ones are not valid anymore
+        ok = PeekRFM32(RFM_DISCOVERY_EPOCH_OFFSET, ringEpoch);
+        ringEpoch = (ringEpoch & ~RFM_DISCOVERY_CLOSED) + 1u;
+        if ((ringEpoch & RFM_DISCOVERY_CLOSED) != 0u) {
+            ringEpoch = 1u;
+        }
+        //the table header is written before the epoch is opened
+        if (ok) {
+            ok = PokeRFM32(RFM_TABLE_VERSION_OFFSET, RFM_TABLE_VERSION);
+        }
+        if (ok) {
+            ok = PokeRFM32(RFM_TABLE_SIZE_OFFSET, nOfHosts);
+        }
+        if (ok) {
+            ok = StampDiagnosticOwnData(ringEpoch);
+        }
+        if (ok) {
+            ok = PokeRFM32(RFM_DISCOVERY_EPOCH_OFFSET, ringEpoch);
+        }
+        if (ok) {
+            REPORT_ERROR(ErrorManagement::Information, "Discovery epoch %d opened", ringEpoch);
+        }
+    }
+    else {
+        //the slave joins the epoch opened by the master, if any. Otherwise it will join it during the discovery
+        ok = PeekRFM32(RFM_DISCOVERY_EPOCH_OFFSET, ringEpoch);
+        if ((ringEpoch & RFM_DISCOVERY_CLOSED) != 0u) {
+            ringEpoch = 0u;
+        }
+        if (ok) {
+            ok = StampDiagnosticOwnData(ringEpoch);
+        }
+    }
+
+    if (!ok) {
+        REPORT_ERROR(ErrorManagement::InitialisationError, "Could not write on the RFM the host data: writeoffset, outputsize, downsamplefactor");
+    }
+
+    return ok;
+
+}
+
+bool RFM2g::StampDiagnosticOwnData(const RFM2G_UINT32 epoch) {
+
+    bool ok, ok1, ok2, ok3, ok4, ok5, ok6;
+
+    RFM2G_UINT32 entryOffset = RFM_START_PROTOCOL + nodeIdNumber * SIZE_OF_HOST_PROTOCOL_DATA;
+
+    //the entry is invalidated while it is rewritten, the epoch word is written last
+    ok1 = PokeRFM32(entryOffset + 4 * sizeof(uint32), 0u);
+    ok2 = PokeRFM32(entryOffset, writeoffset);
+    ok3 = PokeRFM32(entryOffset + sizeof(uint32), outputsize);
+    ok4 = PokeRFM32(entryOffset + 2 * sizeof(uint32), downsamplefactor);
+    ok5 = PokeRFM32(entryOffset + 3 * sizeof(uint32), hostslots);
+    ok6 = PokeRFM32(entryOffset + 4 * sizeof(uint32), epoch);
+
+    ok = ok1 && ok2 && ok3 && ok4 && ok5 && ok6;
+
+    if (ok) {
+        discoveryepoch = epoch;
+    }
+
+    return ok;
+
+}
+
+ErrorManagement::ErrorType RFM2g::SetInitialInfo(HostReadPlan &plan) {
+
+    ErrorManagement::ErrorType err;
+
+    //when replaying the table is the last one read from the record file
+    if (replaying) {
+        err.fatalError = !replayTableValid;
+        if (!err.fatalError) {
+            MemoryOperationsHelper::Copy(plan.hostsProtocolInfo, replayTable, nOfHosts * SIZE_OF_HOST_PROTOCOL_DATA);
+        }
+        else {
+            REPORT_ERROR(ErrorManagement::FatalError, "No protocol table read from the record file yet");
+        }
+        return err;
+    }
+
+    REPORT_ERROR(ErrorManagement::Information, "The diagnostic counter protocol setting is starting");
+
+    //here starts collecting the hosts information
+    //the table is read with programmed IO straight into the plan, this is not done in the RT phase
+    //the discovery waits until all the NumberOfHosts entries are stamped with the epoch opened by the master
+
+    bool ok = true;
+    bool discovered = false;
+    bool timedOut = false;
+
+    uint64 startTicks = HighResolutionTimer::Counter();
+    uint64 lastReportTicks = startTicks;
+    uint64 discoveryTimeOutTicks = static_cast<uint64>(discoveryTimeOut * static_cast<float64>(HighResolutionTimer::Frequency()));
+
+    while (ok && !discovered && !timedOut) {
+
+        RFM2G_UINT32 ringEpoch = 0u;
+
+        ok = PeekRFM32(RFM_DISCOVERY_EPOCH_OFFSET, ringEpoch);
+
+        bool ringOpen = (ringEpoch != 0u) && ((ringEpoch & RFM_DISCOVERY_CLOSED) == 0u);
+
+        //the table opened by the master must have the same layout of this host
+        if (ok && ringOpen) {
+            RFM2G_UINT32 tableVersion = 0u;
+            RFM2G_UINT32 tableSize = 0u;
+            ok = PeekRFM32(RFM_TABLE_VERSION_OFFSET, tableVersion);
+            if (ok) {
+                ok = PeekRFM32(RFM_TABLE_SIZE_OFFSET, tableSize);
+            }
+            if (ok && ((tableVersion != RFM_TABLE_VERSION) || (tableSize != nOfHosts))) {
+                REPORT_ERROR(ErrorManagement::FatalError, "Protocol table version %d with %d entries, expected version %d with %d entries", tableVersion,
+                             tableSize, RFM_TABLE_VERSION, nOfHosts);
+                ok = false;
+            }
+        }
+
+        //a new epoch has been opened by the master (e.g. it started after this host): join it
+        if (ok && ringOpen && (discoveryepoch != ringEpoch)) {
+            (void) fastMuxRFM.FastLock(TTInfiniteWait, 0.);
+            ok = StampDiagnosticOwnData(ringEpoch);
+            fastMuxRFM.FastUnLock();
+        }
+
+        if (ok) {
+            if (rfmmapped) {
+                ok = ReadRFM<true, false, false>(RFM_START_PROTOCOL, plan.hostsProtocolInfo, nOfHosts * SIZE_OF_HOST_PROTOCOL_DATA);
+            }
+            else {
+                ok = ReadRFM<false, false, false>(RFM_START_PROTOCOL, plan.hostsProtocolInfo, nOfHosts * SIZE_OF_HOST_PROTOCOL_DATA);
+            }
+        }
+
+        uint32 validHosts = 0u;
+        uint32 firstMissingHost = nOfHosts;
+
+        if (ok) {
+            uint32 i = 0u;
+
+            for (i = 0u; i < nOfHosts; i++) {
+                if (ringOpen && (plan.hostsProtocolInfo[i].hostTableEpoch == ringEpoch)) {
+                    validHosts++;
+                }
+                else if (firstMissingHost == nOfHosts) {
+                    firstMissingHost = i;
+                }
+            }
+
+            discovered = (validHosts == nOfHosts);
+        }
+
+        if (ok && !discovered) {
+            uint64 nowTicks = HighResolutionTimer::Counter();
+
+            timedOut = ((nowTicks - startTicks) > discoveryTimeOutTicks);
+
+            if ((nowTicks - lastReportTicks) > HighResolutionTimer::Frequency()) {
+                REPORT_ERROR(ErrorManagement::Information, "Discovery: %d/%d hosts valid in epoch %d, waiting for host %d", validHosts, nOfHosts,
+                             ringOpen ? ringEpoch : 0u, firstMissingHost);
+                lastReportTicks = nowTicks;
+            }
+
+            if (!timedOut) {
+                Sleep::Sec(0.001);
+            }
+            else {
+                REPORT_ERROR(ErrorManagement::Timeout, "Discovery timed out after %f s with %d/%d hosts valid, host %d missing", discoveryTimeOut, validHosts,
+                             nOfHosts, firstMissingHost);
+            }
+        }
+    }
+
+    ok = ok && discovered;
+
+    //the hosts must agree on the slots of the segments
+    if (ok) {
+        uint32 i = 0u;
+        for (i = 0u; i < nOfHosts; i++) {
+            if (plan.hostsProtocolInfo[i].hostSlots != hostslots) {
+                REPORT_ERROR(ErrorManagement::FatalError, "Host %d has %d slots per segment, this host %d: PingPongSlots must be the same on all the hosts", i,
+                             plan.hostsProtocolInfo[i].hostSlots, hostslots);
+                ok = false;
+            }
+        }
+    }
+
+    if (ok) {
+
+        REPORT_ERROR(ErrorManagement::Information, "Discovery completed in %f s", HighResolutionTimer::Period() * (HighResolutionTimer::Counter() - startTicks));
+
+        uint32 i = 0u;
+
+        for (i = 0u; i < nOfHosts; i++) {
+
+            REPORT_ERROR(ErrorManagement::Information, "*** Host number %d: *** ", i);
+            REPORT_ERROR(ErrorManagement::Information, "writeoffset %d: ", plan.hostsProtocolInfo[i].hostWriteoffset);
+            REPORT_ERROR(ErrorManagement::Information, "outputsize %d:  ", plan.hostsProtocolInfo[i].hostOutputsize);
+            REPORT_ERROR(ErrorManagement::Information, "downsamplefactor %d: ", plan.hostsProtocolInfo[i].hostDownsamplefactor);
+            REPORT_ERROR(ErrorManagement::Information, "\n");
+
+        }
+    }
+
+    //OPTIONAL: si potrebbe fare il check della topologia, per vedere la coerenza (ciascuno scrive in maniera esclusiva nel proprio pezzo e non si scrivono addosso, o indentificare un buco)
+
+    if (ok) {
+        err.fatalError = false;
+    }
+    else {
+        err.fatalError = true;
+        REPORT_ERROR(ErrorManagement::FatalError, "Failed to set the initial info");
+    }
+
+    return err;
+
+}
+
+bool RFM2g::CheckMemoryLayout(HostReadPlan &plan) {
+
+    bool ok = true;
+
+    uint32 i = 0u;
+
+    //insertion sort of the hosts by the RFM offset of their segment
+    for (i = 0u; i < nOfHosts; i++) {
+        uint32 j = i;
+        while ((j > 0u) && (HostSegmentOffset(plan, plan.hostsByOffset[j - 1u]) > HostSegmentOffset(plan, i))) {
+            plan.hostsByOffset[j] = plan.hostsByOffset[j - 1u];
+            j--;
+        }
+        plan.hostsByOffset[j] = i;
+    }
+
+    //gaps are allowed, overlaps are not
+    for (i = 0u; (i + 1u < nOfHosts) && ok; i++) {
+        uint32 host = plan.hostsByOffset[i];
+        uint32 nextHost = plan.hostsByOffset[i + 1u];
+
+        ok = (HostSegmentOffset(plan, host) + hostslots * HostSlotStride(plan, host) <= HostSegmentOffset(plan, nextHost));
+
+        if (!ok) {
+            REPORT_ERROR(ErrorManagement::FatalError, "The segment of the host with NodeIdNumber %d overlaps the segment of the host with NodeIdNumber %d", host,
+                         nextHost);
+        }
+    }
+
+    return ok;
+
+}
+
+bool RFM2g::InitializeReadPlans() {
+
+    bool ok = true;
+
+    uint32 p = 0u;
+
+    for (p = 0u; (p < 2u) && ok; p++) {
+        readPlans[p].hostsProtocolInfo = new HostCounterProcInfo[nOfHosts];
+        readPlans[p].hostsToReadInfo = new HostReadMappingInfo[nOfHosts];
+        readPlans[p].diagnosticRatio = new float32[nOfHosts];
+        readPlans[p].hostsByOffset = new uint32[nOfHosts];
+        readPlans[p].hostsToRead = new uint32[nOfHosts];
+        //at most a counter and a data transfer per window for each host
+        readPlans[p].transfers = new RFMReadTransferInfo[MaxReadIntervals()];
+        readPlans[p].copies = new RFMReadCopyInfo[numberOfReadWindows * nOfHosts];
+        readPlans[p].ringLoadPerCycle = 0.0;
+        readPlans[p].readBytesPerCycle = 0u;
+
+        ok = (readPlans[p].hostsProtocolInfo != NULL) && (readPlans[p].hostsToReadInfo != NULL) && (readPlans[p].diagnosticRatio != NULL)
+                && (readPlans[p].hostsByOffset != NULL) && (readPlans[p].hostsToRead != NULL) && (readPlans[p].transfers != NULL)
+                && (readPlans[p].copies != NULL);
+
+        if (ok) {
+            uint32 i = 0u;
+
+            for (i = 0u; i < nOfHosts; i++) {
+                readPlans[p].hostsProtocolInfo[i].hostWriteoffset = 0u;
+                readPlans[p].hostsProtocolInfo[i].hostOutputsize = 0u;
+                readPlans[p].hostsProtocolInfo[i].hostDownsamplefactor = 0u;
+                readPlans[p].hostsProtocolInfo[i].hostSlots = 0u;
+                readPlans[p].hostsProtocolInfo[i].hostTableEpoch = 0u;
+                readPlans[p].hostsToReadInfo[i].hostToReadOffset = 0u;
+                readPlans[p].hostsToReadInfo[i].hostToReadSize = 0u;
+                readPlans[p].hostsToReadInfo[i].hostCounterInternalOffset = 0u;
+                readPlans[p].hostsToReadInfo[i].hostFirstCopy = 0u;
+                readPlans[p].hostsToReadInfo[i].hostNumberOfCopies = 0u;
+                readPlans[p].hostsToReadInfo[i].hostWholeRead = false;
+                readPlans[p].diagnosticRatio[i] = 0;
+                readPlans[p].hostsByOffset[i] = i;
+                readPlans[p].hostsToRead[i] = 0u;
+            }
+        }
+    }
+
+    if (!ok) {
+        REPORT_ERROR(ErrorManagement::FatalError, "Failed to allocate the read plans");
+    }
+
+    return ok;
+
+}
+
+ErrorManagement::ErrorType RFM2g::InternalRFMRemapping(HostReadPlan &plan) {
+
+    ErrorManagement::ErrorType err;
+
+    uint32 i = 0u;
+    uint32 w = 0u;
+
+    //the plan may be a recycled one
+    plan.numberOfHostsToRead = 0u;
+    plan.numberOfTransfers = 0u;
+    plan.numberOfCopies = 0u;
+    plan.inputsizeRemapped = 0u;
+
+    for (i = 0u; i < nOfHosts; i++) {
+        plan.hostsToReadInfo[i].hostToReadOffset = 0u;
+        plan.hostsToReadInfo[i].hostToReadSize = 0u;
+        plan.hostsToReadInfo[i].hostCounterInternalOffset = 0u;
+        plan.hostsToReadInfo[i].hostSlotCounterInternalOffset = 0u;
+        plan.hostsToReadInfo[i].hostFirstCopy = 0u;
+        plan.hostsToReadInfo[i].hostNumberOfCopies = 0u;
+        plan.hostsToReadInfo[i].hostWholeRead = false;
+        plan.hostsToReadInfo[i].hostCounterOffset = 0u;
+        plan.hostsToReadInfo[i].hostFirstTransfer = 0u;
+        plan.hostsToReadInfo[i].hostNumberOfTransfers = 0u;
+    }
+
+    //the windows given by HostId follow the discovered layout
+    for (w = 0u; (w < numberOfReadWindows) && (!err.fatalError); w++) {
+        if (readWindows[w].windowHostId != RFM2G_NO_HOST) {
+            uint32 host = readWindows[w].windowHostId;
+            err.fatalError = (readWindows[w].windowSize > plan.hostsProtocolInfo[host].hostOutputsize);
+            if (err.fatalError) {
+                REPORT_ERROR(ErrorManagement::FatalError, "The read window %s (%d bytes) is larger than the output of host %d (%d bytes)",
+                             readWindowNames[w].Buffer(), readWindows[w].windowSize, host, plan.hostsProtocolInfo[host].hostOutputsize);
+            }
+            else {
+                readWindows[w].windowOffset = plan.hostsProtocolInfo[host].hostWriteoffset;
+            }
+        }
+    }
+
+    //this cycle browse, in RFM order, all the hosts whose payload intersects any read window
+    //the needed RFM intervals (data and counters) are collected in the transfers and merged afterwards
+    for (i = 0u; (i < nOfHosts) && (!err.fatalError); i++) {
+
+        uint32 host = plan.hostsByOffset[i];
+
+        RFM2G_UINT32 hostStart = plan.hostsProtocolInfo[host].hostWriteoffset;
+        RFM2G_UINT32 hostEnd = hostStart + plan.hostsProtocolInfo[host].hostOutputsize;
+
+        //the RFM position of the host data is shifted by the trailers of the hosts with lower NodeIdNumber
+        RFM2G_UINT32 shift = host * trailersize;
+
+        HostReadMappingInfo &hostInfo = plan.hostsToReadInfo[host];
+        hostInfo.hostFirstCopy = plan.numberOfCopies;
+
+        for (w = 0u; w < numberOfReadWindows; w++) {
+
+            RFM2G_UINT32 windowStart = readWindows[w].windowOffset;
+            RFM2G_UINT32 windowEnd = windowStart + readWindows[w].windowSize;
+
+            RFM2G_UINT32 readStart = (hostStart > windowStart) ? hostStart : windowStart;
+            RFM2G_UINT32 readEnd = (hostEnd < windowEnd) ? hostEnd : windowEnd;
+
+            if (readStart < readEnd) {
+                //the copy keeps the layout of the window, the gaps are left untouched
+                RFMReadCopyInfo &copy = plan.copies[plan.numberOfCopies];
+                copy.copyOffset = readStart + shift;
+                copy.copySize = readEnd - readStart;
+                copy.copyDestination = readWindows[w].windowBuffer + (readStart - windowStart);
+                plan.numberOfCopies++;
+
+                AddReadInterval(plan, copy.copyOffset, copy.copySize, host);
+                if (hostslots == 2u) {
+                    AddReadInterval(plan, copy.copyOffset + HostSlotStride(plan, host), copy.copySize, host);
+                }
+
+                if ((hostInfo.hostNumberOfCopies == 0u) || (copy.copyOffset < hostInfo.hostToReadOffset)) {
+                    hostInfo.hostToReadOffset = copy.copyOffset;
+                }
+                hostInfo.hostToReadSize = hostInfo.hostToReadSize + copy.copySize;
+                hostInfo.hostNumberOfCopies++;
+                //the CRC can be checked only if the whole payload is read
+                if (copy.copySize == plan.hostsProtocolInfo[host].hostOutputsize) {
+                    hostInfo.hostWholeRead = true;
+                }
+            }
+        }
+
+        if (hostInfo.hostNumberOfCopies > 0u) {
+            hostInfo.hostCounterOffset = HostSegmentOffset(plan, host) + plan.hostsProtocolInfo[host].hostOutputsize;
+            AddReadInterval(plan, hostInfo.hostCounterOffset, trailersize, host);
+            if (hostslots == 2u) {
+                AddReadInterval(plan, hostInfo.hostCounterOffset + HostSlotStride(plan, host), trailersize, host);
+            }
+
+            plan.hostsToRead[plan.numberOfHostsToRead] = host;
+            plan.numberOfHostsToRead++;
+        }
+
+    }
+
+    if (!err.fatalError) {
+        MergeReadIntervals(plan);
+
+        for (i = 0u; i < plan.numberOfHostsToRead; i++) {
+            uint32 host = plan.hostsToRead[i];
+            HostReadMappingInfo &hostInfo = plan.hostsToReadInfo[host];
+            hostInfo.hostCounterInternalOffset = InternalOffsetOf(plan, hostInfo.hostCounterOffset);
+            hostInfo.hostSlotCounterInternalOffset = hostInfo.hostCounterInternalOffset;
+
+            uint32 c = 0u;
+            for (c = hostInfo.hostFirstCopy; c < hostInfo.hostFirstCopy + hostInfo.hostNumberOfCopies; c++) {
+                plan.copies[c].copyInternalOffset = InternalOffsetOf(plan, plan.copies[c].copyOffset);
+                plan.copies[c].copySlotInternalOffset = plan.copies[c].copyInternalOffset;
+            }
+
+            //the second slot of each host is laid in the internal buffer as the first one
+            if (hostslots == 2u) {
+                RFM2G_UINT32 slotStride = HostSlotStride(plan, host);
+                hostInfo.hostSlotCounterInternalOffset = InternalOffsetOf(plan, hostInfo.hostCounterOffset + slotStride);
+                for (c = hostInfo.hostFirstCopy; c < hostInfo.hostFirstCopy + hostInfo.hostNumberOfCopies; c++) {
+                    plan.copies[c].copySlotInternalOffset = InternalOffsetOf(plan, plan.copies[c].copyOffset + slotStride);
+                }
+            }
+        }
+
+        //the transfers of a host are consecutive, being sorted by offset and never merged across hosts with FreshnessGate
+        for (i = 0u; i < plan.numberOfTransfers; i++) {
+            HostReadMappingInfo &hostInfo = plan.hostsToReadInfo[plan.transfers[i].transferHost];
+            if (hostInfo.hostNumberOfTransfers == 0u) {
+                hostInfo.hostFirstTransfer = i;
+            }
+            hostInfo.hostNumberOfTransfers++;
+        }
+    }
+
+    /////here the print of each host////
+
+    REPORT_ERROR(ErrorManagement::Information, "*** Remapping of host %d **** ", nodeIdNumber);
+
+    for (i = 0u; i < plan.numberOfHostsToRead; i++) {
+
+        uint32 host = plan.hostsToRead[i];
+
+        REPORT_ERROR(ErrorManagement::Information, "host %d  remapped offset: %d ", host, plan.hostsToReadInfo[host].hostToReadOffset);
+        REPORT_ERROR(ErrorManagement::Information, "host %d  remapped size: %d ", host, plan.hostsToReadInfo[host].hostToReadSize);
+
+    }
+
+    for (i = 0u; i < plan.numberOfTransfers; i++) {
+
+        REPORT_ERROR(ErrorManagement::Information, "transfer %d: offset %d size %d ", i, plan.transfers[i].transferOffset, plan.transfers[i].transferSize);
+
+    }
+
+    //////////////////////////////////
+
+    return err;
+
+}
+
+void RFM2g::AddReadInterval(HostReadPlan &plan,
+                            const RFM2G_UINT32 start,
+                            const RFM2G_UINT32 size,
+                            const uint32 host) {
+
+    //insertion by RFM offset, the windows may overlap or be given in any order
+    uint32 j = plan.numberOfTransfers;
+    while ((j > 0u) && (plan.transfers[j - 1u].transferOffset > start)) {
+        plan.transfers[j] = plan.transfers[j - 1u];
+        j--;
+    }
+    plan.transfers[j].transferOffset = start;
+    plan.transfers[j].transferSize = size;
+    plan.transfers[j].transferInternalOffset = 0u;
+    plan.transfers[j].transferHost = host;
+    plan.numberOfTransfers++;
+
+}
+
+void RFM2g::MergeReadIntervals(HostReadPlan &plan) {
+
+    uint32 merged = 0u;
+    uint32 i = 0u;
+
+    for (i = 0u; i < plan.numberOfTransfers; i++) {
+        RFM2G_UINT32 start = plan.transfers[i].transferOffset;
+        RFM2G_UINT32 end = start + plan.transfers[i].transferSize;
+
+        bool merge = (merged > 0u);
+
+        if (merge) {
+            RFMReadTransferInfo &lastTransfer = plan.transfers[merged - 1u];
+            RFM2G_UINT32 lastEnd = lastTransfer.transferOffset + lastTransfer.transferSize;
+
+            //overlapping intervals, or a gap that costs less to read than a further transfer
+            merge = (start <= lastEnd) || ((start - lastEnd) <= readmergethreshold);
+
+            //the hosts must stay in separate transfers to be read independently
+            if (freshnessgate) {
+                merge = merge && (lastTransfer.transferHost == plan.transfers[i].transferHost);
+            }
+
+            if (merge && (end > lastEnd)) {
+                lastTransfer.transferSize = end - lastTransfer.transferOffset;
+            }
+        }
+
+        if (!merge) {
+            plan.transfers[merged].transferOffset = start;
+            plan.transfers[merged].transferSize = end - start;
+            plan.transfers[merged].transferHost = plan.transfers[i].transferHost;
+            merged++;
+        }
+    }
+
+    plan.numberOfTransfers = merged;
+    plan.inputsizeRemapped = 0u;
+
+    for (i = 0u; i < plan.numberOfTransfers; i++) {
+        plan.transfers[i].transferInternalOffset = plan.inputsizeRemapped;
+        plan.inputsizeRemapped = plan.inputsizeRemapped + plan.transfers[i].transferSize;
+    }
+
+}
+
+RFM2G_UINT32 RFM2g::InternalOffsetOf(const HostReadPlan &plan,
+                                     const RFM2G_UINT32 offset) const {
+
+    RFM2G_UINT32 internalOffset = 0u;
+
+    uint32 i = 0u;
+    bool found = false;
+
+    for (i = 0u; (i < plan.numberOfTransfers) && (!found); i++) {
+        found = (offset >= plan.transfers[i].transferOffset) && (offset < plan.transfers[i].transferOffset + plan.transfers[i].transferSize);
+        if (found) {
+            internalOffset = plan.transfers[i].transferInternalOffset + (offset - plan.transfers[i].transferOffset);
+        }
+    }
+
+    return internalOffset;
+
+}
+
+RFM2G_UINT32 RFM2g::SystemBufferSize() const {
+    return RFM_START_PROTOCOL + nOfHosts * SIZE_OF_HOST_PROTOCOL_DATA;
+}
+
+RFM2G_UINT32 RFM2g::ReadMergeSlack() const {
+    //each merge reads at most readmergethreshold bytes of gap, there are at most a counter and a transfer per window for each host
+    return MaxReadIntervals() * readmergethreshold;
+}
+
+uint32 RFM2g::MaxReadIntervals() const {
+    return (numberOfReadWindows + 1u) * nOfHosts * hostslots;
+}
+
+RFM2G_UINT32 RFM2g::HostSlotStride(const HostReadPlan &plan,
+                                   const uint32 host) const {
+    return plan.hostsProtocolInfo[host].hostOutputsize + trailersize;
+}
+
+RFM2G_UINT32 RFM2g::HostSegmentOffset(const HostReadPlan &plan,
+                                       const uint32 host) const {
+    return plan.hostsProtocolInfo[host].hostWriteoffset + host * trailersize;
+}
+
+ErrorManagement::ErrorType RFM2g::inputSizeRemapping(HostReadPlan &plan) {
+
+    ErrorManagement::ErrorType err;
+
+    if (plan.numberOfHostsToRead == 0u) {
+        REPORT_ERROR(ErrorManagement::FatalError, "No host writes in the read windows");
+        err.fatalError = true;
+        return err;
+    }
+
+    //the inputsizeRemapped (the sum of the transfers) is computed by InternalRFMRemapping
+
+    //
+    REPORT_ERROR(ErrorManagement::Information, "inputsizeRemapped: %d in %d transfers", plan.inputsizeRemapped, plan.numberOfTransfers);
+    //
+
+    //the plan is not used by the RT thread, with programmed IO its internal buffer is sized exactly on the new layout
+    if (!usedma) {
+        if (plan.inputBufferInternalSize != plan.inputsizeRemapped) {
+            if (plan.inputBufferInternal != NULL) {
+                free(plan.inputBufferInternal);
+            }
+            plan.inputBufferInternal = (uint8*) malloc(plan.inputsizeRemapped);
+            plan.inputBufferInternalSize = (plan.inputBufferInternal != NULL) ? plan.inputsizeRemapped : 0u;
+            if (plan.inputBufferInternal != NULL) {
+                memset(plan.inputBufferInternal, 0, plan.inputBufferInternalSize);
+            }
+        }
+    }
+    else {
+        plan.inputBufferInternal = (uint8*) pInputBufferInternal;
+        plan.inputBufferInternalSize = inputbufferinternalsize;
+    }
+
+    //the RT thread must never overflow the buffers with the new plan
+    err.fatalError = (plan.inputsizeRemapped > plan.inputBufferInternalSize);
+    if (err.fatalError) {
+        REPORT_ERROR(ErrorManagement::FatalError, "The remapped input (%d bytes) does not fit the allocated buffer (%d bytes)", plan.inputsizeRemapped,
+                     plan.inputBufferInternalSize);
+    }
+
+    return err;
+
+}
+
+bool RFM2g::InitializeReadWindows(StructuredDataI &data) {
+
+    bool ok = true;
+
+    //the first window is the InputBuffer at ReadOffset, the others are given in ReadWindows
+    uint32 numberOfExtraWindows = 0u;
+    bool hasReadWindows = data.MoveRelative("ReadWindows");
+    if (hasReadWindows) {
+        numberOfExtraWindows = data.GetNumberOfChildren();
+    }
+
+    numberOfReadWindows = 1u + numberOfExtraWindows;
+    readWindows = new ReadWindowInfo[numberOfReadWindows];
+    readWindowNames = new StreamString[numberOfReadWindows];
+
+    uint32 w = 0u;
+    for (w = 0u; w < numberOfReadWindows; w++) {
+        readWindows[w].windowOffset = 0u;
+        readWindows[w].windowSize = 0u;
+        readWindows[w].windowHostId = RFM2G_NO_HOST;
+        readWindows[w].windowSignalIdx = RFM2G_NO_SIGNAL;
+        readWindows[w].windowBuffer = static_cast<uint8*>(NULL);
+    }
+
+    readWindowNames[0u] = "InputBuffer";
+    readWindows[0u].windowOffset = readoffset;
+    readWindows[0u].windowSignalIdx = 2u;
+
+    for (w = 1u; (w < numberOfReadWindows) && ok; w++) {
+        readWindowNames[w] = data.GetChildName(w - 1u);
+        ok = data.MoveRelative(readWindowNames[w].Buffer());
+        if (ok) {
+            uint32 hostId = 0u;
+            if (data.Read("HostId", hostId)) {
+                ok = (hostId < nOfHosts);
+                if (!ok) {
+                    REPORT_ERROR(ErrorManagement::ParametersError, "The HostId of the read window %s must be less than NumberOfHosts", readWindowNames[w].Buffer());
+                }
+                readWindows[w].windowHostId = hostId;
+            }
+            else if (data.Read("ReadOffset", readWindows[w].windowOffset)) {
+                ok = (readWindows[w].windowOffset >= SystemBufferSize());
+                if (!ok) {
+                    REPORT_ERROR(ErrorManagement::ParametersError, "The ReadOffset of the read window %s is in the reserved area", readWindowNames[w].Buffer());
+                }
+            }
+            else {
+                REPORT_ERROR(ErrorManagement::ParametersError, "The read window %s needs either a HostId or a ReadOffset", readWindowNames[w].Buffer());
+                ok = false;
+            }
+            if (!data.MoveToAncestor(1u)) {
+                ok = false;
+            }
+        }
+        else {
+            REPORT_ERROR(ErrorManagement::ParametersError, "The read window %s must be a block", readWindowNames[w].Buffer());
+        }
+    }
+
+    if (hasReadWindows) {
+        if (!data.MoveToAncestor(1u)) {
+            ok = false;
+        }
+    }
+
+    return ok;
+
+}
+
+bool RFM2g::InitializeCounterRead() {
+
+    counterRead = new int32[nOfHosts];
+
+    bool ok = (counterRead != NULL);
+
+    if (ok) {
+        uint32 i = 0u;
+
+        for (i = 0u; i < nOfHosts; i++) {
+            counterRead[i] = 0;
+        }
+    }
+    else {
+        REPORT_ERROR(ErrorManagement::FatalError, "Failed to allocate counterRead");
+    }
+
+    return ok;
+
+}
+
+bool RFM2g::InitializeDiagnosticData() {
+
+    diagnosticData = new float32[nOfHosts];
+
+    bool ok = (diagnosticData != NULL);
+
+    if (ok) {
+        uint32 i = 0u;
+
+        for (i = 0u; i < nOfHosts; i++) {
+            diagnosticData[i] = 0;
+        }
+    }
+    else {
+        REPORT_ERROR(ErrorManagement::FatalError, "Failed to allocate  diagnosticData");
+    }
+
+    return ok;
+
+}
+
+bool RFM2g::InitializeIntegrityFailures() {
+
+    integrityFailures = new uint32[nOfHosts];
+
+    bool ok = (integrityFailures != NULL);
+
+    if (ok) {
+        uint32 i = 0u;
+
+        for (i = 0u; i < nOfHosts; i++) {
+            integrityFailures[i] = 0u;
+        }
+    }
+    else {
+        REPORT_ERROR(ErrorManagement::FatalError, "Failed to allocate integrityFailures");
+    }
+
+    return ok;
+
+}
+
+bool RFM2g::InitializeRecordReplay(StructuredDataI &data) {
+
+    bool ok = true;
+
+    recording = data.Read("Record", recordfile);
+    replaying = data.Read("Replay", replayfile);
+
+    if (recording && replaying) {
+        REPORT_ERROR(ErrorManagement::ParametersError, "Record and Replay cannot be given together");
+        ok = false;
+    }
+
+    if (ok && recording) {
+        if (!data.Read("RecordBufferCycles", recordbuffercycles)) {
+            REPORT_ERROR(ErrorManagement::Information, "RecordBufferCycles not given. Default is %d cycles", recordbuffercycles);
+        }
+        if (recordbuffercycles < 2u) {
+            REPORT_ERROR(ErrorManagement::ParametersError, "RecordBufferCycles must be at least 2");
+            ok = false;
+        }
+    }
+
+    if (ok && replaying) {
+        StreamString pacingStr;
+        if (!data.Read("ReplayPacing", pacingStr)) {
+            pacingStr = "Recorded";
+        }
+        if (pacingStr == "Recorded") {
+            replaypaced = true;
+        }
+        else if (pacingStr == "AsFastAsPossible") {
+            replaypaced = false;
+        }
+        else {
+            REPORT_ERROR(ErrorManagement::InitialisationError, "The ReplayPacing must be \"Recorded\" or \"AsFastAsPossible\"");
+            ok = false;
+        }
+
+        //there is no card: the read plans use programmed IO buffers
+        if (usedma || mapmemory) {
+            REPORT_ERROR(ErrorManagement::Warning, "UseDMA and MapMemory are ignored when replaying");
+            usedma = false;
+            mapmemory = false;
+        }
+
+        if (ok) {
+            replayTable = new HostCounterProcInfo[nOfHosts];
+            ok = (replayTable != NULL);
+        }
+        if (ok) {
+            ok = recorder.OpenReplay(replayfile.Buffer(), nOfHosts, trailersize);
+            if (!ok) {
+                REPORT_ERROR(ErrorManagement::InitialisationError, "Could not open %s or it was not recorded with NumberOfHosts=%d and IntegrityCheck=%d",
+                             replayfile.Buffer(), nOfHosts, integritycheck ? 1u : 0u);
+            }
+        }
+        if (ok) {
+            REPORT_ERROR(ErrorManagement::Information, "Replaying %s, the card is not used", replayfile.Buffer());
+        }
+    }
+
+    return ok;
+
+}
+
+bool RFM2g::InitializeLogger(StructuredDataI &data) {
+
+    uint32 queueSize = LOG_QUEUE_SIZE;
+    if (!data.Read("LogQueueSize", queueSize)) {
+        REPORT_ERROR(ErrorManagement::Information, "LogQueueSize not given. Default is %d records", queueSize);
+    }
+
+    float64 minInterval = LOG_MIN_INTERVAL;
+    if (!data.Read("LogMinInterval", minInterval)) {
+        REPORT_ERROR(ErrorManagement::Information, "LogMinInterval not given. Default is %f seconds", minInterval);
+    }
+
+    uint8 tmp;
+    if (data.Read("LogTrace", tmp)) {
+        logtrace = (tmp == 1u);
+    }
+
+    bool ok = logger.Initialise(RFM2G_LOG_MESSAGES, queueSize);
+
+    //the integer arguments first, then the float value
+    if (ok) {
+        ok = logger.SetMessage(RFM2G_LOG_MASTER_STEP_FAILED, ErrorManagement::Warning, "Master step of cycle %d failed after %d retries, RFM counter lag %d", 3u,
+                               minInterval);
+        ok = ok && logger.SetMessage(RFM2G_LOG_TERMINATION_SENT, ErrorManagement::Information, "Sending termination message at cycle %d", 1u, minInterval);
+        ok = ok && logger.SetMessage(RFM2G_LOG_MAX_CYCLES, ErrorManagement::Information, "Max Number of cycles Reached (cycle %d)", 1u, minInterval);
+        ok = ok && logger.SetMessage(RFM2G_LOG_NO_CURRENT_CYCLE, ErrorManagement::Warning, "Slave %d cannot get the current cycle", 1u, minInterval);
+        ok = ok && logger.SetMessage(RFM2G_LOG_MASTER_EPOCH, ErrorManagement::Information, "Master epoch %d: node %d drives the ring", 2u, 0.0);
+        ok = ok && logger.SetMessage(RFM2G_LOG_TAKEOVER, ErrorManagement::Warning, "Master lost at cycle %d, node %d took over in %f s", 2u, 0.0);
+        ok = ok && logger.SetMessage(RFM2G_LOG_TAKEOVER_FAILED, ErrorManagement::FatalError, "Master lost at cycle %d, node %d could not take over", 2u,
+                                     minInterval);
+        ok = ok && logger.SetMessage(RFM2G_LOG_STANDBY_AGAIN, ErrorManagement::Warning, "Master epoch %d opened by another node, node %d is standby again",
+                                     2u, 0.0);
+        ok = ok && logger.SetMessage(RFM2G_LOG_CYCLE_LOSSES, ErrorManagement::Warning, "%d consecutive cycles with losses, %d cycles lost", 2u, minInterval);
+        ok = ok && logger.SetMessage(RFM2G_LOG_TRACE_MASTER, ErrorManagement::Debug, "Master counter= %d (%d step retries)", 2u, 0.0);
+        ok = ok && logger.SetMessage(RFM2G_LOG_TRACE_SLAVE, ErrorManagement::Debug, "Ring counter= %d, slave counter= %d, localCounter= %d", 3u, 0.0);
+        ok = ok && logger.SetMessage(RFM2G_LOG_TRACE_START, ErrorManagement::Debug, "Counter %d: start cycle %d not reached yet", 2u, 0.0);
+        ok = ok && logger.SetMessage(RFM2G_LOG_TRACE_HOST, ErrorManagement::Debug, "Counter of host %d: %d, diagnostic data %f", 2u, 0.0);
+        ok = ok && logger.SetMessage(RFM2G_LOG_PACING_SLIP, ErrorManagement::Warning, "Paced master late at cycle %d: %d cycle starts skipped", 2u,
+                                     minInterval);
+        ok = ok && logger.SetMessage(RFM2G_LOG_DEADLINE_MISS, ErrorManagement::Warning, "Cycle %d completed %f s after the next master tick", 1u,
+                                     minInterval);
+        ok = ok && logger.SetMessage(RFM2G_LOG_PARAMETER_APPLY, ErrorManagement::Information, "Parameters version %d applied at cycle %d (apply cycle %d)",
+                                     3u, 0.0);
+        ok = ok && logger.SetMessage(RFM2G_LOG_EPOCH_JOINED, ErrorManagement::Information, "Discovery epoch %d opened by the master, node %d joined it",
+                                     2u, 0.0);
+        ok = ok && logger.SetMessage(RFM2G_LOG_PARAMETER_INVALID, ErrorManagement::Warning, "Parameters version %d discarded: too large or CRC mismatch", 1u,
+                                     0.0);
+    }
+
+    if (ok) {
+        logger.SetEmitHook(&RFM2g::PostPendingMessages, this);
+        ok = logger.Start();
+    }
+
+    if (!ok) {
+        REPORT_ERROR(ErrorManagement::FatalError, "Failed to start the deferred logger");
+    }
+
+    return ok;
+
+}
+
+bool RFM2g::InitializeSimulatedCard(StructuredDataI &data) {
+
+    rfmmemorysize = SIMULATED_MEMORY_SIZE;
+    if (!data.Read("SimulatedMemorySize", rfmmemorysize)) {
+        REPORT_ERROR(ErrorManagement::Information, "SimulatedMemorySize not given. Default is %d bytes", rfmmemorysize);
+    }
+
+    //the stand-in is plain memory: no DMA engine
+    if (usedma) {
+        REPORT_ERROR(ErrorManagement::Warning, "UseDMA is ignored with the shared memory stand-in");
+        usedma = false;
+    }
+
+    const char8 *shmName = device.Buffer() + strlen(RFM2G_SIMULATED_DEVICE_PREFIX);
+
+    //the first node creates the segment, the others open it
+    int32 fd = shm_open(shmName, O_CREAT | O_RDWR, 0666);
+    bool ok = (fd >= 0);
+
+    if (ok) {
+        struct stat shmStat;
+        ok = (fstat(fd, &shmStat) == 0);
+        if (ok && (static_cast<uint64>(shmStat.st_size) < rfmmemorysize)) {
+            ok = (ftruncate(fd, static_cast<off_t>(rfmmemorysize)) == 0);
+        }
+    }
+
+    if (ok) {
+        void *memory = mmap(NULL, rfmmemorysize, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        ok = (memory != MAP_FAILED);
+        if (ok) {
+            pRfmMemory = static_cast<volatile uint8*>(memory);
+            rfmmapped = true;
+        }
+    }
+
+    if (fd >= 0) {
+        (void) close(fd);
+    }
+
+    if (ok) {
+        REPORT_ERROR(ErrorManagement::Warning, "The card is simulated by the shared memory %s (%d bytes)", shmName, rfmmemorysize);
+    }
+    else {
+        REPORT_ERROR(ErrorManagement::InitialisationError, "Could not map the shared memory %s (%d bytes)", shmName, rfmmemorysize);
+    }
+
+    return ok;
+
+}
+
+bool RFM2g::InitializeFaults(StructuredDataI &data) {
+
+    bool ok = true;
+
+    if (data.MoveRelative("Faults")) {
+        ok = faults.Initialise(data, nodeIdNumber);
+        if (!data.MoveToAncestor(1u)) {
+            ok = false;
+        }
+        faultsenabled = ok && faults.IsEnabled();
+    }
+
+    //without UseDMA (always the case on the shared memory stand-in) there is no DMA transfer to delay
+    if (ok && faultsenabled && !usedma && faults.IsConfigured(RFM2G_FAULT_DMA_DELAY)) {
+        REPORT_ERROR(ErrorManagement::InitialisationError, "The DMADelay fault requires UseDMA=1 and a card (the shared memory stand-in has no DMA)");
+        ok = false;
+    }
+
+    if (!ok) {
+        REPORT_ERROR(ErrorManagement::InitialisationError, "Invalid Faults block");
+    }
+
+    return ok;
+
+}
+
+bool RFM2g::MailboxSend(const uint32 destination,
+                        const void * const message,
+                        const uint32 size) {
+    return (MailboxPost(destination, message, size) == RFM2G_MAILBOX_POSTED);
+}
+
+uint8 RFM2g::MailboxPost(const uint32 destination,
+                         const void * const message,
+                         const uint32 size) {
+    uint8 status = RFM2G_MAILBOX_POSTED;
+    if (!(mailboxenabled && (destination < nOfHosts) && (destination != nodeIdNumber) && (size <= mailboxmessagesize))) {
+        status = RFM2G_MAILBOX_INVALID;
+    }
+    //a single producer per mailbox: the other destinations are not held
+    else if (!mailboxTxMux[destination].FastTryLock()) {
+        status = RFM2G_MAILBOX_BUSY;
+    }
+    else {
+        RFM2G_UINT32 mailbox = MailboxAddress(nodeIdNumber, destination);
+        uint32 head = mailboxTxHead[destination];
+        RFM2G_UINT32 tail = 0u;
+        uint8 *txSlot = mailboxTxSlot + destination * MailboxSlotSize();
+
+        //full when the receiver has not yet taken the message written mailboxslots messages ago
+        bool ok = PeekRFM32(mailbox + RFM2G_MAILBOX_TAIL_OFFSET, tail);
+        if (ok && ((head - tail) >= mailboxslots)) {
+            status = RFM2G_MAILBOX_FULL;
+        }
+        if (ok && (status == RFM2G_MAILBOX_POSTED)) {
+            uint32 words = (size + 3u) & ~3u;
+            RFM2G_UINT32 slot = mailbox + static_cast<RFM2G_UINT32>(sizeof(RFM2gMailboxHeader)) + (head & (mailboxslots - 1u)) * MailboxSlotSize();
+            *reinterpret_cast<uint32*>(txSlot + RFM2G_MAILBOX_SIZE_OFFSET) = size;
+            MemoryOperationsHelper::Copy(txSlot + sizeof(uint32), message, size);
+            //the padding to the word is written too: not the bytes of the previous message
+            MemoryOperationsHelper::Set(txSlot + sizeof(uint32) + size, '\0', words - size);
+            RFM2G_UINT32 slotSize = static_cast<RFM2G_UINT32>(sizeof(uint32)) + words;
+            ok = rfmmapped ? WriteRFM<true, false, false>(slot, txSlot, slotSize) : WriteRFM<false, false, false>(slot, txSlot, slotSize);
+            //the slot before the head
+            if (ok) {
+                head++;
+                ok = PokeRFM32(mailbox + RFM2G_MAILBOX_HEAD_OFFSET, head);
+            }
+            if (ok) {
+                mailboxTxHead[destination] = head;
+            }
+        }
+        if (!ok) {
+            status = RFM2G_MAILBOX_FAILED;
+        }
+        mailboxTxMux[destination].FastUnLock();
+    }
+    return status;
+}
+
+bool RFM2g::MailboxReceive(const uint32 source,
+                           void * const buffer,
+                           const uint32 bufferSize,
+                           uint32 &size) {
+    bool ok = mailboxenabled && (source < nOfHosts) && (source != nodeIdNumber);
+    if (ok) {
+        ok = mailboxRxMux[source].FastTryLock();
+    }
+    if (ok) {
+        RFM2G_UINT32 mailbox = MailboxAddress(source, nodeIdNumber);
+        uint32 tail = mailboxRxTail[source];
+        RFM2G_UINT32 head = 0u;
+
+        ok = PeekRFM32(mailbox + RFM2G_MAILBOX_HEAD_OFFSET, head) && (head != tail);
+        RFM2G_UINT32 slot = mailbox + static_cast<RFM2G_UINT32>(sizeof(RFM2gMailboxHeader)) + (tail & (mailboxslots - 1u)) * MailboxSlotSize();
+        RFM2G_UINT32 messageSize = 0u;
+        if (ok) {
+            ok = PeekRFM32(slot + RFM2G_MAILBOX_SIZE_OFFSET, messageSize);
+            size = messageSize;
+        }
+        //a corrupted size is dropped, a too small buffer leaves the message to a retry
+        bool corrupted = ok && (messageSize > mailboxmessagesize);
+        ok = ok && (!corrupted) && (messageSize <= bufferSize);
+        if (ok && (messageSize > 0u)) {
+            RFM2G_UINT32 payload = slot + static_cast<RFM2G_UINT32>(sizeof(uint32));
+            ok = rfmmapped ? ReadRFM<true, false, false>(payload, buffer, messageSize) : ReadRFM<false, false, false>(payload, buffer, messageSize);
+        }
+        //the slot is read before it is released to the sender
+        if (ok || corrupted) {
+            tail++;
+            if (PokeRFM32(mailbox + RFM2G_MAILBOX_TAIL_OFFSET, tail)) {
+                mailboxRxTail[source] = tail;
+            }
+        }
+        mailboxRxMux[source].FastUnLock();
+    }
+    return ok;
+}
+
+ErrorManagement::ErrorType RFM2g::MailboxSendText(uint32 destination,
+                                                  StreamString text) {
+    ErrorManagement::ErrorType err = ErrorManagement::NoError;
+    uint8 status = MailboxPost(destination, text.Buffer(), static_cast<uint32>(text.Size()));
+    if (status == RFM2G_MAILBOX_INVALID) {
+        REPORT_ERROR(ErrorManagement::ParametersError, "Could not post the message to host %d (mailboxes disabled, wrong host or message larger than %d bytes)",
+                     destination, mailboxmessagesize);
+        err = ErrorManagement::ParametersError;
+    }
+    else if (status == RFM2G_MAILBOX_BUSY) {
+        REPORT_ERROR(ErrorManagement::ErrorSharing, "Could not post the message to host %d: another thread is posting to it", destination);
+        err = ErrorManagement::ErrorSharing;
+    }
+    else if (status == RFM2G_MAILBOX_FULL) {
+        REPORT_ERROR(ErrorManagement::CommunicationError, "Could not post the message to host %d: mailbox full", destination);
+        err = ErrorManagement::CommunicationError;
+    }
+    else if (status == RFM2G_MAILBOX_FAILED) {
+        REPORT_ERROR(ErrorManagement::CommunicationError, "Could not post the message to host %d: RFM access failed", destination);
+        err = ErrorManagement::CommunicationError;
+    }
+    return err;
+}
+
+bool RFM2g::PublishParameters(const void * const block,
+                              const uint32 size,
+                              const uint32 applyDelay) {
+    bool ok = master && parametersenabled && (size <= parametersize) && (applyDelay >= PARAMETER_MIN_APPLY_DELAY);
+    if (ok) {
+        ok = parameterMux.FastTryLock();
+    }
+    if (ok) {
+        RFM2G_UINT32 iteration = 0u;
+        ok = PeekRFM32(RFM_ITERATION_OFFSET, iteration);
+        int32 cycle = static_cast<int32>(iteration);
+
+        //a single version in flight: the nodes must all have applied the previous one
+        ok = ok && ((parameterPublished == 0u) || ((cycle - parameterPublishedApply) >= 0));
+
+        //a host with a DownSampleFactor runs once every so many master cycles: it must have one to read the block
+        uint32 minApplyDelay = PARAMETER_MIN_APPLY_DELAY;
+        uint32 h = 0u;
+        for (h = 0u; (h < nOfHosts) && ok; h++) {
+            RFM2G_UINT32 hostDownsamplefactor = 0u;
+            ok = PeekRFM32(RFM_START_PROTOCOL + h * SIZE_OF_HOST_PROTOCOL_DATA + 2 * sizeof(uint32), hostDownsamplefactor);
+            if (ok && ((hostDownsamplefactor + 1u) > minApplyDelay)) {
+                minApplyDelay = hostDownsamplefactor + 1u;
+            }
+        }
+        if (ok && (applyDelay < minApplyDelay)) {
+            REPORT_ERROR(ErrorManagement::Warning, "Apply delay of %d cycles below the largest DownSampleFactor of the protocol table + 1 (%d)", applyDelay,
+                         minApplyDelay);
+            ok = false;
+        }
+
+        if (ok) {
+            uint32 version = parameterPublished + 1u;
+            if (version == 0u) {
+                version = 1u;
+            }
+            int32 applyCycle = cycle + static_cast<int32>(applyDelay);
+            MemoryOperationsHelper::Set(parameterPublishing, '\0', parametersize);
+            MemoryOperationsHelper::Copy(parameterPublishing, block, size);
+
+            //version 0 while the block is written, the new version last
+            ok = PokeRFM32(parameteroffset + RFM2G_PARAMETER_VERSION_OFFSET, 0u);
+            ok = ok && PokeRFM32(parameteroffset + RFM2G_PARAMETER_APPLY_CYCLE_OFFSET, static_cast<RFM2G_UINT32>(applyCycle));
+            ok = ok && PokeRFM32(parameteroffset + RFM2G_PARAMETER_SIZE_OFFSET, size);
+            ok = ok && PokeRFM32(parameteroffset + RFM2G_PARAMETER_CRC_OFFSET, RFM2gCRC32C::Compute(parameterPublishing, size));
+            RFM2G_UINT32 blockOffset = parameteroffset + static_cast<RFM2G_UINT32>(sizeof(RFM2gParameterHeader));
+            ok = ok
+                    && (rfmmapped ? WriteRFM<true, false, false>(blockOffset, parameterPublishing, parametersize) :
+                            WriteRFM<false, false, false>(blockOffset, parameterPublishing, parametersize));
+            ok = ok && PokeRFM32(parameteroffset + RFM2G_PARAMETER_VERSION_OFFSET, version);
+
+            if (ok) {
+                parameterPublished = version;
+                parameterPublishedApply = applyCycle;
+                REPORT_ERROR(ErrorManagement::Information, "Parameters version %d (%d bytes) published at cycle %d, applied at cycle %d", version, size, cycle,
+                             applyCycle);
+            }
+        }
+        parameterMux.FastUnLock();
+    }
+    return ok;
+}
+
+ErrorManagement::ErrorType RFM2g::PublishParameterFile(StreamString fileName,
+                                                       uint32 applyDelay) {
+    ErrorManagement::ErrorType err = ErrorManagement::NoError;
+
+    if (!(master && parametersenabled)) {
+        REPORT_ERROR(ErrorManagement::IllegalOperation, "The parameters are published by the master, with ParameterOffset");
+        err = ErrorManagement::IllegalOperation;
+    }
+
+    FILE *file = static_cast<FILE*>(NULL);
+    if (err.ErrorsCleared()) {
+        file = fopen(fileName.Buffer(), "rb");
+        if (file == NULL) {
+            REPORT_ERROR(ErrorManagement::OSError, "Could not open %s", fileName.Buffer());
+            err = ErrorManagement::OSError;
+        }
+    }
+
+    if (err.ErrorsCleared()) {
+        //one byte more than ParameterSize to detect a file too large
+        uint8 *block = new uint8[parametersize + 1u];
+        size_t size = fread(block, 1u, parametersize + 1u, file);
+        if (size > parametersize) {
+            REPORT_ERROR(ErrorManagement::ParametersError, "%s is larger than ParameterSize (%d bytes)", fileName.Buffer(), parametersize);
+            err = ErrorManagement::ParametersError;
+        }
+        else if (!PublishParameters(block, static_cast<uint32>(size), applyDelay)) {
+            REPORT_ERROR(ErrorManagement::IllegalOperation, "Could not publish %s: apply delay too short (at least %d cycles) or previous version not applied yet",
+                         fileName.Buffer(), PARAMETER_MIN_APPLY_DELAY);
+            err = ErrorManagement::IllegalOperation;
+        }
+        else {
+            //nothing to do, reported by PublishParameters
+        }
+        delete[] block;
+        (void) fclose(file);
+    }
+
+    return err;
+}
+
+bool RFM2g::InitializeParameters(StructuredDataI &data) {
+
+    bool ok = true;
+
+    parametersenabled = data.Read("ParameterOffset", parameteroffset);
+
+    if (parametersenabled && replaying) {
+        REPORT_ERROR(ErrorManagement::Warning, "The parameter broadcast is disabled when replaying");
+        parametersenabled = false;
+    }
+
+    if (parametersenabled) {
+        uint64 parametersEnd = 0u;
+        if (!data.Read("ParameterSize", parametersize)) {
+            REPORT_ERROR(ErrorManagement::InitialisationError, "ParameterSize must be given with ParameterOffset");
+            ok = false;
+        }
+        else {
+            parametersEnd = static_cast<uint64>(parameteroffset) + sizeof(RFM2gParameterHeader) + parametersize;
+        }
+
+        if (!ok) {
+            //already reported
+        }
+        else if ((parametersize == 0u) || ((parametersize % sizeof(RFM2G_UINT32)) != 0u)) {
+            REPORT_ERROR(ErrorManagement::InitialisationError, "ParameterSize must be a positive multiple of 4");
+            ok = false;
+        }
+        else if ((parameteroffset < SystemBufferSize()) || ((parameteroffset % sizeof(RFM2G_UINT32)) != 0u)) {
+            REPORT_ERROR(ErrorManagement::InitialisationError, "ParameterOffset must be aligned to 4 and above the reserved area (%d bytes)", SystemBufferSize());
+            ok = false;
+        }
+        else if ((rfmmemorysize > 0u) && (parametersEnd > rfmmemorysize)) {
+            REPORT_ERROR(ErrorManagement::InitialisationError, "The parameter block (%d bytes from %d) exceeds the RFM memory (%d bytes)", parametersize,
+                         parameteroffset, rfmmemorysize);
+            ok = false;
+        }
+        else if (bulkenabled && (parametersEnd > bulkoffset) && ((static_cast<uint64>(bulkoffset) + static_cast<uint64>(nOfHosts) * bulksize) > parameteroffset)) {
+            REPORT_ERROR(ErrorManagement::InitialisationError, "The parameter block overlaps the bulk regions");
+            ok = false;
+        }
+        else if (mailboxenabled && (parametersEnd > mailboxoffset) && (MailboxAddress(nOfHosts, 0u) > parameteroffset)) {
+            REPORT_ERROR(ErrorManagement::InitialisationError, "The parameter block overlaps the mailboxes");
+            ok = false;
+        }
+    }
+
+    if (ok && parametersenabled) {
+        ok = RFM2gCRC32C::Initialise();
+    }
+
+    if (ok && parametersenabled) {
+        parameters = new uint8[parametersize];
+        parameterStaging = new uint8[parametersize];
+        parameterPublishing = new uint8[parametersize];
+        parameterMux.Create();
+        MemoryOperationsHelper::Set(parameters, '\0', parametersize);
+
+        //the block in force, if any: a node started later applies it at once
+        RFM2G_UINT32 version = 0u;
+        ok = PeekRFM32(parameteroffset + RFM2G_PARAMETER_VERSION_OFFSET, version);
+        if (ok && (version != 0u)) {
+            bool valid = false;
+            bool fetched = rfmmapped ? FetchParameters<true>(version, valid) : FetchParameters<false>(version, valid);
+            if (fetched && valid) {
+                MemoryOperationsHelper::Copy(parameters, parameterStaging, parametersize);
+                parameterVersion = version;
+                REPORT_ERROR(ErrorManagement::Information, "Parameters version %d in force", version);
+            }
+            else {
+                REPORT_ERROR(ErrorManagement::Warning, "Could not read the parameters version %d, waiting for the next one", version);
+            }
+            parameterSeenVersion = fetched ? version : 0u;
+        }
+        //the master continues the versions of the previous run
+        parameterPublished = version;
+        parameterPublishedApply = 0;
+
+        if (ok) {
+            REPORT_ERROR(ErrorManagement::Information, "Parameter broadcast: %d bytes from %d", parametersize, parameteroffset);
+        }
+    }
+
+    return ok;
+
+}
+
+template<bool mapped>
+bool RFM2g::FetchParameters(const uint32 version,
+                            bool &valid) {
+    RFM2G_UINT32 applyCycle = 0u;
+    RFM2G_UINT32 size = 0u;
+    RFM2G_UINT32 crc = 0u;
+    RFM2G_UINT32 versionAfter = 0u;
+
+    bool ok = PeekRFM32(parameteroffset + RFM2G_PARAMETER_APPLY_CYCLE_OFFSET, applyCycle);
+    ok = ok && PeekRFM32(parameteroffset + RFM2G_PARAMETER_SIZE_OFFSET, size);
+    ok = ok && PeekRFM32(parameteroffset + RFM2G_PARAMETER_CRC_OFFSET, crc);
+    valid = ok && (size <= parametersize);
+    if (valid) {
+        ok = ReadRFM<mapped, false, false>(parameteroffset + static_cast<RFM2G_UINT32>(sizeof(RFM2gParameterHeader)), parameterStaging, parametersize);
+        MemoryOperationsHelper::Set(parameterStaging + size, '\0', parametersize - size);
+    }
+    //a version changed while reading is a new publication: read again
+    ok = ok && PeekRFM32(parameteroffset + RFM2G_PARAMETER_VERSION_OFFSET, versionAfter) && (versionAfter == version);
+    if (ok && valid) {
+        valid = (RFM2gCRC32C::Compute(parameterStaging, size) == crc);
+        parameterApplyCycle = static_cast<int32>(applyCycle);
+    }
+    return ok;
+}
+
+template<bool mapped>
+inline void RFM2g::ParameterUpdate(const int32 ringCycle) {
+    RFM2G_UINT32 version = 0u;
+
+    //the only read of the steady state
+    if (PeekRFM32(parameteroffset + RFM2G_PARAMETER_VERSION_OFFSET, version) && (version != 0u) && (version != parameterSeenVersion)) {
+        bool valid = false;
+        if (FetchParameters<mapped>(version, valid)) {
+            parameterSeenVersion = version;
+            if (valid) {
+                parameterStagedVersion = version;
+                parameterStaged = true;
+            }
+            else {
+                parameterFailures++;
+                (void) logger.Log(RFM2G_LOG_PARAMETER_INVALID, static_cast<int32>(version));
+            }
+        }
+    }
+
+    //the signed difference survives the wrap of the ring counter
+    if (parameterStaged && ((ringCycle - parameterApplyCycle) >= 0)) {
+        MemoryOperationsHelper::Copy(parameters, parameterStaging, parametersize);
+        parameterVersion = parameterStagedVersion;
+        parameterStaged = false;
+        (void) logger.Log(RFM2G_LOG_PARAMETER_APPLY, static_cast<int32>(parameterVersion), ringCycle, parameterApplyCycle);
+    }
+}
+
+bool RFM2g::InitializeMailboxes(StructuredDataI &data) {
+
+    bool ok = true;
+
+    mailboxenabled = data.Read("MailboxOffset", mailboxoffset);
+
+    if (mailboxenabled && replaying) {
+        REPORT_ERROR(ErrorManagement::Warning, "The mailboxes are disabled when replaying");
+        mailboxenabled = false;
+    }
 
-    result = RFM2gPoke32(rfmhandle, RFM_START_PROTOCOL + nodeIdNumber * SIZE_OF_HOST_PROTOCOL_DATA, writeoffset);
-    ok1 = (result == RFM2G_SUCCESS);
+    if (mailboxenabled) {
+        if (!data.Read("MailboxSlots", mailboxslots)) {
+            REPORT_ERROR(ErrorManagement::Information, "MailboxSlots not given. Default is %d", mailboxslots);
+        }
+        if (!data.Read("MailboxMessageSize", mailboxmessagesize)) {
+            REPORT_ERROR(ErrorManagement::Information, "MailboxMessageSize not given. Default is %d bytes", mailboxmessagesize);
+        }
 
-    result = RFM2gPoke32(rfmhandle, RFM_START_PROTOCOL + nodeIdNumber * SIZE_OF_HOST_PROTOCOL_DATA + sizeof(uint32), outputsize);
-    ok2 = (result == RFM2G_SUCCESS);
+        uint64 mailboxesEnd = static_cast<uint64>(mailboxoffset) + static_cast<uint64>(nOfHosts) * nOfHosts * MailboxSlotSize() * mailboxslots
+                + static_cast<uint64>(nOfHosts) * nOfHosts * sizeof(RFM2gMailboxHeader);
 
-    result = RFM2gPoke32(rfmhandle, RFM_START_PROTOCOL + nodeIdNumber * SIZE_OF_HOST_PROTOCOL_DATA + 2 * sizeof(uint32), downsamplefactor);
-    ok3 = (result == RFM2G_SUCCESS);
+        if ((mailboxslots == 0u) || ((mailboxslots & (mailboxslots - 1u)) != 0u)) {
+            REPORT_ERROR(ErrorManagement::InitialisationError, "MailboxSlots must be a power of 2");
+            ok = false;
+        }
+        else if ((mailboxmessagesize == 0u) || ((mailboxmessagesize % sizeof(RFM2G_UINT32)) != 0u)) {
+            REPORT_ERROR(ErrorManagement::InitialisationError, "MailboxMessageSize must be a positive multiple of 4");
+            ok = false;
+        }
+        else if ((mailboxoffset < SystemBufferSize()) || ((mailboxoffset % sizeof(RFM2G_UINT32)) != 0u)) {
+            REPORT_ERROR(ErrorManagement::InitialisationError, "MailboxOffset must be aligned to 4 and above the reserved area (%d bytes)", SystemBufferSize());
+            ok = false;
+        }
+        else if ((rfmmemorysize > 0u) && (mailboxesEnd > rfmmemorysize)) {
+            REPORT_ERROR(ErrorManagement::InitialisationError, "The mailboxes (%d hosts, %d slots of %d bytes from %d) exceed the RFM memory (%d bytes)",
+                         nOfHosts, mailboxslots, mailboxmessagesize, mailboxoffset, rfmmemorysize);
+            ok = false;
+        }
+        else if (bulkenabled && (mailboxesEnd > bulkoffset) && ((static_cast<uint64>(bulkoffset) + static_cast<uint64>(nOfHosts) * bulksize) > mailboxoffset)) {
+            REPORT_ERROR(ErrorManagement::InitialisationError, "The mailboxes overlap the bulk regions");
+            ok = false;
+        }
+    }
 
-    ok = ok1 && ok2 && ok3;
+    if (ok && mailboxenabled) {
+        mailboxTxHead = new uint32[nOfHosts];
+        mailboxRxTail = new uint32[nOfHosts];
+        mailboxTxSlot = new uint8[nOfHosts * MailboxSlotSize()];
+        mailboxTxMux = new FastPollingMutexSem[nOfHosts];
+        mailboxRxMux = new FastPollingMutexSem[nOfHosts];
+
+        //the heads continue those of the previous run, the mailboxes to this host are emptied
+        uint32 h;
+        for (h = 0u; (h < nOfHosts) && ok; h++) {
+            RFM2G_UINT32 head = 0u;
+            mailboxTxMux[h].Create();
+            mailboxRxMux[h].Create();
+            mailboxTxHead[h] = 0u;
+            mailboxRxTail[h] = 0u;
+            if (h != nodeIdNumber) {
+                ok = PeekRFM32(MailboxAddress(nodeIdNumber, h) + RFM2G_MAILBOX_HEAD_OFFSET, head);
+                mailboxTxHead[h] = head;
+                ok = ok && PeekRFM32(MailboxAddress(h, nodeIdNumber) + RFM2G_MAILBOX_HEAD_OFFSET, head);
+                ok = ok && PokeRFM32(MailboxAddress(h, nodeIdNumber) + RFM2G_MAILBOX_TAIL_OFFSET, head);
+                mailboxRxTail[h] = head;
+            }
+        }
 
-    if (!ok) {
-        REPORT_ERROR(ErrorManagement::InitialisationError, "Could not write on the RFM the host data: writeoffset, outputsize, downsamplefactor");
+        if (ok) {
+            REPORT_ERROR(ErrorManagement::Information, "Mailboxes: %d slots of %d bytes for each pair of hosts from %d", mailboxslots, mailboxmessagesize,
+                         mailboxoffset);
+        }
+        else {
+            REPORT_ERROR(ErrorManagement::InitialisationError, "Could not resynchronise the mailboxes");
+        }
     }
 
     return ok;
 
 }
 
-ErrorManagement::ErrorType RFM2g::SetInitialInfo() {
+RFM2G_UINT32 RFM2g::MailboxAddress(const uint32 source,
+                                   const uint32 destination) const {
+    uint32 stride = static_cast<uint32>(sizeof(RFM2gMailboxHeader)) + mailboxslots * MailboxSlotSize();
+    return mailboxoffset + (source * nOfHosts + destination) * stride;
+}
 
-    ErrorManagement::ErrorType err;
+uint32 RFM2g::MailboxSlotSize() const {
+    return static_cast<uint32>(sizeof(uint32)) + mailboxmessagesize;
+}
 
-    REPORT_ERROR(ErrorManagement::Information, "The diagnostic counter protocol setting is starting");
+bool RFM2g::InitializeBulkChannel(StructuredDataI &data) {
 
-    //here starts collecting the hosts information
+    bool ok = true;
 
-    int result;
+    bulkenabled = data.Read("BulkOffset", bulkoffset);
 
-    if (!usedma) {
-        result = RFM2gRead(rfmhandle, RFM_START_PROTOCOL, pInputBuffer, nOfHosts * SIZE_OF_HOST_PROTOCOL_DATA);
+    if (bulkenabled && replaying) {
+        REPORT_ERROR(ErrorManagement::Warning, "The bulk channel is disabled when replaying");
+        bulkenabled = false;
     }
-    else {
-        if (waitdma) {
-            result = RFM2gReadDMAwaitfinish(rfmhandle, RFM_START_PROTOCOL, pInputBuffer, nOfHosts * SIZE_OF_HOST_PROTOCOL_DATA);
+
+    if (bulkenabled) {
+        if (!data.Read("BulkSize", bulksize)) {
+            REPORT_ERROR(ErrorManagement::InitialisationError, "BulkSize must be given with BulkOffset");
+            ok = false;
         }
-        else {
-            result = RFM2gReadDMA(rfmhandle, RFM_START_PROTOCOL, pInputBuffer, nOfHosts * SIZE_OF_HOST_PROTOCOL_DATA);
+        else if ((bulksize <= sizeof(RFM2gBulkHeader)) || ((bulksize % sizeof(RFM2G_UINT32)) != 0u)) {
+            REPORT_ERROR(ErrorManagement::InitialisationError, "BulkSize must be a multiple of 4 larger than the header (%d bytes)",
+                         static_cast<uint32>(sizeof(RFM2gBulkHeader)));
+            ok = false;
+        }
+        else if ((bulkoffset < SystemBufferSize()) || ((bulkoffset % sizeof(RFM2G_UINT32)) != 0u)) {
+            REPORT_ERROR(ErrorManagement::InitialisationError, "BulkOffset must be aligned to 4 and above the reserved area (%d bytes)", SystemBufferSize());
+            ok = false;
+        }
+        else if ((rfmmemorysize > 0u) && ((static_cast<uint64>(bulkoffset) + static_cast<uint64>(nOfHosts) * bulksize) > rfmmemorysize)) {
+            REPORT_ERROR(ErrorManagement::InitialisationError, "The bulk regions (%d hosts of %d bytes from %d) exceed the RFM memory (%d bytes)", nOfHosts,
+                         bulksize, bulkoffset, rfmmemorysize);
+            ok = false;
+        }
+    }
 
+    if (ok && bulkenabled) {
+        if (!data.Read("BulkBytesPerCycle", bulkbytespercycle)) {
+            REPORT_ERROR(ErrorManagement::Information, "BulkBytesPerCycle not given. Default is %d bytes", bulkbytespercycle);
+        }
+        //the fragments stay aligned to the words of the region
+        if ((bulkbytespercycle == 0u) || ((bulkbytespercycle % sizeof(RFM2G_UINT32)) != 0u)) {
+            REPORT_ERROR(ErrorManagement::InitialisationError, "BulkBytesPerCycle must be a positive multiple of 4");
+            ok = false;
         }
     }
 
-    bool ok = (result == RFM2G_SUCCESS);
+    if (ok && bulkenabled) {
+        ok = RFM2gCRC32C::Initialise();
+    }
 
-    if (ok) {
-        // copy the info from the DMA.
+    if (ok && bulkenabled) {
+        bulkTxBuffer = new uint8[BulkCapacity()];
+        bulkRx = new RFM2gBulkReceiveState[nOfHosts];
+        bulkRxAssembly = new uint8[nOfHosts * BulkCapacity()];
+        bulkRxComplete = new uint8[nOfHosts * BulkCapacity()];
+        bulkMux.Create();
+
+        uint32 h;
+        for (h = 0u; h < nOfHosts; h++) {
+            bulkRx[h].blobId = 0u;
+            bulkRx[h].totalSize = 0u;
+            bulkRx[h].crc = 0u;
+            bulkRx[h].received = 0u;
+            bulkRx[h].completeId = 0u;
+            bulkRx[h].completeSize = 0u;
+            bulkRx[h].crcFailures = 0u;
+        }
 
-        hostsProtocolInfo = new HostCounterProcInfo[nOfHosts];
+        //the identifiers continue those of the previous run, so that the receivers see the new blobs
+        ok = PeekRFM32(bulkoffset + nodeIdNumber * bulksize + RFM2G_BULK_BLOB_ID_OFFSET, bulkTxId);
+        //the receivers follow the region from now on
+        ok = ok && PokeRFM32(bulkoffset + nodeIdNumber * bulksize + RFM2G_BULK_CHANNEL_OFFSET, RFM2G_BULK_CHANNEL_MAGIC);
+    }
 
-        ok = (hostsProtocolInfo != NULL);
+    if (ok && bulkenabled) {
+        bulkReceiving = true;
+        ok = (pthread_create(&bulkReceiver, NULL, &RFM2g::BulkReceiverThread, this) == 0);
+        bulkReceiverStarted = ok;
+        if (ok) {
+            REPORT_ERROR(ErrorManagement::Information, "Bulk channel: %d bytes per host from %d, %d bytes per cycle", BulkCapacity(), bulkoffset,
+                         bulkbytespercycle);
+        }
+        else {
+            REPORT_ERROR(ErrorManagement::FatalError, "Could not start the bulk receiver thread");
+        }
     }
 
-    if (ok) {
+    return ok;
 
-        uint32 i = 0u;
+}
 
-        HostCounterProcInfo *reintPinput = reinterpret_cast<HostCounterProcInfo*>(pInputBuffer);
+uint32 RFM2g::BulkCapacity() const {
+    return bulksize - static_cast<uint32>(sizeof(RFM2gBulkHeader));
+}
 
-        for (i = 0u; i < nOfHosts; i++) {
+bool RFM2g::RegionClearOfData(const char8 * const regionName,
+                              const uint64 regionStart,
+                              const uint64 regionEnd) const {
 
-            hostsProtocolInfo[i] = *(reintPinput + i);
+    bool ok = true;
 
-            REPORT_ERROR(ErrorManagement::Information, "*** Host number %d: *** ", i);
-            REPORT_ERROR(ErrorManagement::Information, "writeoffset %d: ", hostsProtocolInfo[i].hostWriteoffset);
-            REPORT_ERROR(ErrorManagement::Information, "outputsize %d:  ", hostsProtocolInfo[i].hostOutputsize);
-            REPORT_ERROR(ErrorManagement::Information, "downsamplefactor %d: ", hostsProtocolInfo[i].hostDownsamplefactor);
-            REPORT_ERROR(ErrorManagement::Information, "\n");
+    uint64 segmentStart = static_cast<uint64>(writeoffset) + static_cast<uint64>(nodeIdNumber) * trailersize;
+    uint64 segmentEnd = segmentStart + static_cast<uint64>(hostslots) * (outputsize + trailersize);
+    if ((regionStart < segmentEnd) && (segmentStart < regionEnd)) {
+        REPORT_ERROR(ErrorManagement::ParametersError, "The region of the %s overlaps the data segment of this host (%d bytes from %d)", regionName,
+                     static_cast<uint32>(segmentEnd - segmentStart), static_cast<uint32>(segmentStart));
+        ok = false;
+    }
 
+    //the windows of a HostId follow the protocol table of that host, they are in its data segment
+    uint32 w = 0u;
+    for (w = 0u; (w < numberOfReadWindows) && ok; w++) {
+        if (readWindows[w].windowHostId == RFM2G_NO_HOST) {
+            uint64 windowStart = readWindows[w].windowOffset;
+            uint64 windowEnd = windowStart + readWindows[w].windowSize;
+            if ((regionStart < windowEnd) && (windowStart < regionEnd)) {
+                REPORT_ERROR(ErrorManagement::ParametersError, "The region of the %s overlaps the read window %s (%d bytes from %d)", regionName, readWindowNames[w].Buffer(),
+                             readWindows[w].windowSize, readWindows[w].windowOffset);
+                ok = false;
+            }
         }
     }
 
-    //OPTIONAL: si potrebbe fare il check della topologia, per vedere la coerenza (ciascuno scrive in maniera esclusiva nel proprio pezzo e non si scrivono addosso, o indentificare un buco)
+    return ok;
+}
 
-    // note: is it also possible to direcly copy the memory with the following line
-    // MemoryOperationsHelper::Copy(OutBufferPtr,DACBufferPtr,numberOfSamples*sizeof(uint16));
+void RFM2g::PostPendingMessages(void *dataSource) {
+    RFM2g *rfm = static_cast<RFM2g*>(dataSource);
 
-    if (ok) {
-        err.fatalError = false;
+    if (rfm->termMessagePending) {
+        rfm->termMessagePending = false;
+        ReferenceT < Message > termMessage = rfm->Get(0);
+        if (termMessage.IsValid()) {
+            if (!SendMessage(termMessage, rfm)) {
+                REPORT_ERROR(ErrorManagement::Warning, "Could not send the termination message");
+            }
+        }
     }
-    else {
-        err.fatalError = true;
-        REPORT_ERROR(ErrorManagement::FatalError, "Failed to set the initial info");
+
+    if (rfm->lossMessagePending) {
+        rfm->lossMessagePending = false;
+        if (rfm->lossMessage.IsValid()) {
+            if (!SendMessage(rfm->lossMessage, rfm)) {
+                REPORT_ERROR(ErrorManagement::Warning, "Could not send the cycle loss message");
+            }
+        }
     }
+}
 
-    return err;
+void *RFM2g::BulkReceiverThread(void *dataSource) {
+    RFM2g *rfm = static_cast<RFM2g*>(dataSource);
+
+    //as the logger emitter, the receiver must never preempt the real-time threads
+    struct sched_param param;
+    param.sched_priority = 0;
+    (void) pthread_setschedparam(pthread_self(), SCHED_OTHER, &param);
+    (void) nice(10);
+
+    while (rfm->bulkReceiving) {
+        rfm->BulkReceive();
+        (void) usleep(1000u);
+    }
 
+    return NULL;
 }
 
-bool RFM2g::CheckMemoryContiguity() {
+void RFM2g::BulkReceive() {
+    uint32 h;
+    for (h = 0u; h < nOfHosts; h++) {
+        if (h != nodeIdNumber) {
+            RFM2gBulkReceiveState &state = bulkRx[h];
+            RFM2G_UINT32 region = bulkoffset + h * bulksize;
+            RFM2G_UINT32 blobId = 0u;
+            RFM2G_UINT32 totalSize = 0u;
+            RFM2G_UINT32 crc = 0u;
+            RFM2G_UINT32 written = 0u;
+            RFM2G_UINT32 channel = 0u;
+
+            //a host without the channel may have anything in its region: it is not followed
+            bool ok = PeekRFM32(region + RFM2G_BULK_CHANNEL_OFFSET, channel) && (channel == RFM2G_BULK_CHANNEL_MAGIC);
+            ok = ok && PeekRFM32(region + RFM2G_BULK_BLOB_ID_OFFSET, blobId);
+            ok = ok && (blobId != 0u) && (blobId != state.completeId);
+            if (ok) {
+                ok = PeekRFM32(region + RFM2G_BULK_TOTAL_SIZE_OFFSET, totalSize);
+                ok = ok && PeekRFM32(region + RFM2G_BULK_CRC_OFFSET, crc);
+                ok = ok && PeekRFM32(region + RFM2G_BULK_BYTES_WRITTEN_OFFSET, written);
+                ok = ok && (totalSize <= BulkCapacity());
+            }
+            //a new blob restarts the reassembly
+            if (ok && (blobId != state.blobId)) {
+                state.blobId = blobId;
+                state.totalSize = totalSize;
+                state.crc = crc;
+                state.received = 0u;
+            }
+            if (ok && (written > state.totalSize)) {
+                written = state.totalSize;
+            }
+            if (ok && (written > state.received)) {
+                uint8 *assembly = bulkRxAssembly + h * BulkCapacity();
+                RFM2G_UINT32 offset = region + static_cast<RFM2G_UINT32>(sizeof(RFM2gBulkHeader)) + state.received;
+                RFM2G_UINT32 size = written - state.received;
+                ok = rfmmapped ? ReadRFM<true, false, false>(offset, assembly + state.received, size) :
+                        ReadRFM<false, false, false>(offset, assembly + state.received, size);
+                if (ok) {
+                    state.received = written;
+                }
+            }
+            //the blob must not have been replaced while it was read
+            if (ok && (state.received == state.totalSize)) {
+                RFM2G_UINT32 blobIdAfter = 0u;
+                ok = PeekRFM32(region + RFM2G_BULK_BLOB_ID_OFFSET, blobIdAfter) && (blobIdAfter == state.blobId);
+                if (ok) {
+                    uint8 *assembly = bulkRxAssembly + h * BulkCapacity();
+                    if (RFM2gCRC32C::Compute(assembly, state.totalSize) == state.crc) {
+                        if (bulkMux.FastLock() == ErrorManagement::NoError) {
+                            MemoryOperationsHelper::Copy(bulkRxComplete + h * BulkCapacity(), assembly, state.totalSize);
+                            state.completeSize = state.totalSize;
+                            state.completeId = state.blobId;
+                            bulkMux.FastUnLock();
+                        }
+                        REPORT_ERROR(ErrorManagement::Information, "Bulk blob %d (%d bytes) received from host %d", state.blobId, state.totalSize, h);
+                    }
+                    else {
+                        //the blob is not read again, the next one replaces it
+                        state.crcFailures++;
+                        state.completeId = state.blobId;
+                        REPORT_ERROR(ErrorManagement::Warning, "CRC mismatch on bulk blob %d from host %d (%d failures)", state.blobId, h, state.crcFailures);
+                    }
+                }
+            }
+        }
+    }
+}
 
-    bool ok = true;
+bool RFM2g::InitializeHostSlots() {
 
-    uint32 i = 0;
+    slotSecond = new bool[nOfHosts];
+    slotCounter = new int32[nOfHosts];
 
-    for (i = 0; i < nOfHosts - 1 && ok; i++) {
+    bool ok = (slotSecond != NULL) && (slotCounter != NULL);
 
-        ok = (hostsProtocolInfo[i].hostWriteoffset + hostsProtocolInfo[i].hostOutputsize == hostsProtocolInfo[i + 1].hostWriteoffset);
-    }
+    if (ok) {
+        uint32 i = 0u;
 
-    if (!ok) {
-        REPORT_ERROR(ErrorManagement::FatalError, "The hosts do not write in a contiguous way. First host not writing correctly has NodeIdNumber: %d", i);
+        for (i = 0u; i < nOfHosts; i++) {
+            slotSecond[i] = false;
+            slotCounter[i] = 0;
+        }
+    }
+    else {
+        REPORT_ERROR(ErrorManagement::FatalError, "Failed to allocate the slot selection");
     }
 
     return ok;
 
 }
 
-bool RFM2g::InitializeHostsToReadInfo() {
+bool RFM2g::InitializeFreshnessGate() {
 
-    hostsToReadInfo = new HostReadMappingInfo[nOfHosts];
+    hostDue = new bool[nOfHosts];
+    hostFresh = new bool[nOfHosts];
 
-    bool ok = (hostsToReadInfo != NULL);
+    bool ok = (hostDue != NULL) && (hostFresh != NULL);
 
     if (ok) {
         uint32 i = 0u;
 
         for (i = 0u; i < nOfHosts; i++) {
-            hostsToReadInfo[i].hostToReadOffset = 0u;
-            hostsToReadInfo[i].hostToReadSize = 0u;
+            hostDue[i] = true;
+            hostFresh[i] = false;
         }
     }
     else {
-        REPORT_ERROR(ErrorManagement::FatalError, "Failed to allocate hostsToReadInfo");
+        REPORT_ERROR(ErrorManagement::FatalError, "Failed to allocate the freshness gate");
     }
 
     return ok;
 
 }
 
-ErrorManagement::ErrorType RFM2g::InternalRFMRemapping() {
-
-    ErrorManagement::ErrorType err;
+void RFM2g::GateFreshHosts(const HostReadPlan &plan) {
 
-    bool exitRemapping = false;
-    bool exitFindFinal = false;
+    int32 iteration = master ? counterAndTimer[0] : localcurrentcycle;
 
     uint32 i = 0u;
 
-    //this cycle browse for all the hosts within the range [readoffset, readoffset+inputsize]
-    for (i = 0u; i < nOfHosts && !exitRemapping; i++) {
+    for (i = 0u; i < plan.numberOfHostsToRead; i++) {
+        uint32 host = plan.hostsToRead[i];
+        int32 hostDownsamplefactor = static_cast<int32>(plan.hostsProtocolInfo[host].hostDownsamplefactor);
 
-        if (hostsProtocolInfo[i].hostWriteoffset >= readoffset && hostsProtocolInfo[i].hostWriteoffset < readoffset + inputsize) {
+        //the host publishes at the multiples of its DownSampleFactor: crossing one makes it due
+        if ((hostDownsamplefactor < 1) || ((iteration / hostDownsamplefactor) != (lastGateIteration / hostDownsamplefactor))) {
+            hostDue[host] = true;
+        }
 
-            if (initialHostToRead == -1) {
-                initialHostToRead = i;
-                finalHostToRead = i;
+        hostFresh[host] = false;
+        if (hostDue[host]) {
+            RFM2G_UINT32 hostCounter = 0u;
+            bool counterOk = PeekRFM32(plan.hostsToReadInfo[host].hostCounterOffset, hostCounter);
+            //with PingPongSlots the newer of the two slot counters
+            if (counterOk && (hostslots == 2u)) {
+                RFM2G_UINT32 slotCounter = 0u;
+                counterOk = PeekRFM32(plan.hostsToReadInfo[host].hostCounterOffset + HostSlotStride(plan, host), slotCounter);
+                if (static_cast<int32>(slotCounter - hostCounter) > 0) {
+                    hostCounter = slotCounter;
+                }
             }
-            else {
-                finalHostToRead = i;
+            if (counterOk) {
+                hostFresh[host] = (static_cast<int32>(hostCounter) != counterRead[host]);
             }
-
-            hostsToReadInfo[i].hostToReadOffset = hostsProtocolInfo[i].hostWriteoffset + i * sizeof(int32);
-            hostsToReadInfo[i].hostToReadSize = hostsProtocolInfo[i].hostOutputsize;
-
-        }
-        else {
-
-            exitRemapping = !(initialHostToRead == -1);
-
+            hostDue[host] = !hostFresh[host];
         }
-
     }
 
-    //here we check if there exists an host before readoffset which is partially read
-    if (initialHostToRead >= 1) {
-        if (hostsProtocolInfo[initialHostToRead - 1].hostWriteoffset + hostsProtocolInfo[initialHostToRead - 1].hostOutputsize - 1 >= readoffset) {
-            initialHostToRead--;
+    lastGateIteration = iteration;
 
-            hostsToReadInfo[initialHostToRead].hostToReadOffset = readoffset + initialHostToRead * sizeof(int32);
-            hostsToReadInfo[initialHostToRead].hostToReadSize = hostsProtocolInfo[initialHostToRead].hostWriteoffset
-                    + hostsProtocolInfo[initialHostToRead].hostOutputsize - readoffset;
+}
 
-        }
-    }
+bool RFM2g::InitializeStatistics(StructuredDataI &data) {
 
-    //here we check if host=0 (i.e., the master) is partially read and it is the unique host to be read
-    if (initialHostToRead == -1) {
-        if (hostsProtocolInfo[0].hostWriteoffset + hostsProtocolInfo[0].hostOutputsize - 1 >= readoffset) {
-            initialHostToRead = 0;
+    bool ok = true;
 
-            hostsToReadInfo[initialHostToRead].hostToReadOffset = readoffset;
-            hostsToReadInfo[initialHostToRead].hostToReadSize = hostsProtocolInfo[initialHostToRead].hostWriteoffset
-                    + hostsProtocolInfo[initialHostToRead].hostOutputsize - readoffset;
+    //the statistics page is optional
+    if (data.Read("StatisticsName", statisticsname)) {
 
+        if (!data.Read("StatisticsPeriod", statisticsperiod)) {
+            REPORT_ERROR(ErrorManagement::Information, "StatisticsPeriod not given. Default is %d cycles", statisticsperiod);
+        }
+        if (statisticsperiod < 1u) {
+            statisticsperiod = 1u;
         }
 
-    }
+        statisticsSize = RFM2gStatisticsPageSize(nOfHosts);
 
-    //here we check if there exists a unique host that is read only partially
-    if (initialHostToRead == -1) {
-        for (i = 0u; i < nOfHosts && !exitFindFinal; i++) {
-            REPORT_ERROR(ErrorManagement::Information, "*** PRINT  **** %d ", i);
-            if (readoffset >= hostsProtocolInfo[i].hostWriteoffset && readoffset < hostsProtocolInfo[i].hostWriteoffset + hostsProtocolInfo[i].hostOutputsize) {
-                initialHostToRead = i;
-                finalHostToRead = i;
-                hostsToReadInfo[i].hostToReadOffset = readoffset + i * sizeof(int32);
-                exitFindFinal = true;
+        int fd = shm_open(statisticsname.Buffer(), O_CREAT | O_RDWR, 0644);
+        ok = (fd >= 0);
+        if (ok) {
+            ok = (ftruncate(fd, statisticsSize) == 0);
+        }
+        if (ok) {
+            void *page = mmap(NULL, statisticsSize, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+            ok = (page != MAP_FAILED);
+            if (ok) {
+                statisticsPage = static_cast<RFM2gStatisticsPage*>(page);
             }
-
         }
-
-    }
-
-    //here we check if the final host is read only partially
-    if (initialHostToRead != -1) {
-        if (hostsProtocolInfo[finalHostToRead].hostWriteoffset + hostsProtocolInfo[finalHostToRead].hostOutputsize >= readoffset + inputsize) {
-
-            hostsToReadInfo[finalHostToRead].hostToReadSize = readoffset + inputsize - hostsToReadInfo[finalHostToRead].hostToReadOffset
-                    + finalHostToRead * sizeof(int32);
-
+        if (fd >= 0) {
+            (void) close(fd);
         }
-    }
-
-    /////here the print of each host////
-
-    REPORT_ERROR(ErrorManagement::Information, "*** Remapping of host %d **** ", nodeIdNumber);
 
-    for (i = 0u; i < nOfHosts; i++) {
-
-        REPORT_ERROR(ErrorManagement::Information, "host %d  remapped offset: %d ", i, hostsToReadInfo[i].hostToReadOffset);
-        REPORT_ERROR(ErrorManagement::Information, "host %d  remapped size: %d ", i, hostsToReadInfo[i].hostToReadSize);
+        if (ok) {
+            statisticsScratch = static_cast<RFM2gStatisticsPage*>(malloc(statisticsSize));
+            ok = (statisticsScratch != NULL);
+        }
 
+        if (ok) {
+            memset(statisticsScratch, 0, statisticsSize);
+            statisticsScratch->magic = RFM2G_STATS_MAGIC;
+            statisticsScratch->version = RFM2G_STATS_VERSION;
+            statisticsScratch->numberOfHosts = nOfHosts;
+            statisticsScratch->nodeIdNumber = nodeIdNumber;
+            statisticsScratch->master = master ? 1u : 0u;
+
+            memset(statisticsPage, 0, statisticsSize);
+            statisticsPage->numberOfHosts = nOfHosts;
+            RFM2gStatisticsPublish(statisticsPage, statisticsScratch, statisticsSize);
+            //the viewer checks magic and version last
+            __sync_synchronize();
+            statisticsPage->version = RFM2G_STATS_VERSION;
+            statisticsPage->magic = RFM2G_STATS_MAGIC;
+
+            REPORT_ERROR(ErrorManagement::Information, "Statistics published in %s every %d cycles", statisticsname.Buffer(), statisticsperiod);
+        }
+        else {
+            REPORT_ERROR(ErrorManagement::InitialisationError, "Could not create the statistics page %s", statisticsname.Buffer());
+        }
     }
 
-    REPORT_ERROR(ErrorManagement::Information, "initial host to read: %d ", initialHostToRead);
-    REPORT_ERROR(ErrorManagement::Information, "final host to read: %d ", finalHostToRead);
-
-    //////////////////////////////////
-
-    err.fatalError = false;
-
-    return err;
+    return ok;
 
 }
 
-ErrorManagement::ErrorType RFM2g::inputSizeRemapping() {
-
-    ErrorManagement::ErrorType err;
-
-    inputsizeRemapped = 0u;
-
-    int32 i = initialHostToRead;
+void RFM2g::PublishStatistics() {
 
-    for (i = initialHostToRead; i < finalHostToRead; i++) {
-        inputsizeRemapped = inputsizeRemapped + hostsToReadInfo[i].hostToReadSize + sizeof(int32);
+    uint64 nowTicks = HighResolutionTimer::Counter();
+    if (lastCycleTicks != 0u) {
+        cycleTicks = nowTicks - lastCycleTicks;
+        if (cycleTicks > cycleTicksMax) {
+            cycleTicksMax = cycleTicks;
+        }
     }
+    lastCycleTicks = nowTicks;
 
-    //the last host has to be whole read since its counter is appended at the end
-    inputsizeRemapped = inputsizeRemapped + hostsProtocolInfo[finalHostToRead].hostOutputsize + sizeof(int32);
-
-    //
-    REPORT_ERROR(ErrorManagement::Information, "inputsizeRemapped: %d ", inputsizeRemapped);
-    //
+    if (writeTicks > writeTicksMax) {
+        writeTicksMax = writeTicks;
+    }
 
-    err.fatalError = false;
+    //the bytes moved by this node are turned into rates every second
+    if (bandwidthTicks == 0u) {
+        bandwidthTicks = nowTicks;
+    }
+    else if ((nowTicks - bandwidthTicks) >= HighResolutionTimer::Frequency()) {
+        float64 elapsed = static_cast<float64>(nowTicks - bandwidthTicks) * HighResolutionTimer::Period();
+        readBandwidth = static_cast<float64>(bytesRead) / elapsed;
+        writeBandwidth = static_cast<float64>(bytesWritten) / elapsed;
+        bytesRead = 0u;
+        bytesWritten = 0u;
+        bandwidthTicks = nowTicks;
+        if ((activePlan != NULL) && (masterPeriodNs > 0u)) {
+            ringLoad = activePlan->ringLoadPerCycle / (static_cast<float64>(masterPeriodNs) * 1e-9);
+        }
+    }
+    if (readTicks > readTicksMax) {
+        readTicksMax = readTicks;
+    }
 
-    return err;
+    statisticsCycles++;
+
+    if ((statisticsPage != NULL) && ((statisticsCycles % statisticsperiod) == 0u)) {
+        float64 usPerTick = 1e6 * HighResolutionTimer::Period();
+
+        RFM2gStatisticsPage *page = statisticsScratch;
+        page->masterNode = masterNode;
+        page->standbyDriving = standbyDriving ? 1u : 0u;
+        page->cycles = statisticsCycles;
+        page->counter = counterAndTimer[0];
+        page->time = counterAndTimer[1];
+        page->realTime = realTime;
+        page->ringTime = ringTime;
+        page->skippedCycles = skippedCycles;
+        page->lostCycles = lostCycles;
+        page->lossEvents = lossEvents;
+        page->masterStepRetries = masterStepRetries;
+        page->writeTimeUs = static_cast<float64>(writeTicks) * usPerTick;
+        page->writeTimeMaxUs = static_cast<float64>(writeTicksMax) * usPerTick;
+        page->readTimeUs = static_cast<float64>(readTicks) * usPerTick;
+        page->readTimeMaxUs = static_cast<float64>(readTicksMax) * usPerTick;
+        page->cycleTimeUs = static_cast<float64>(cycleTicks) * usPerTick;
+        page->cycleTimeMaxUs = static_cast<float64>(cycleTicksMax) * usPerTick;
+        page->failoverTime = failoverTime;
+        page->deadlineMisses = deadlineMisses;
+        page->lastOverrunUs = lastOverrun * 1e6;
+        page->worstOverrunUs = worstOverrun * 1e6;
+        page->readBandwidth = readBandwidth;
+        page->writeBandwidth = writeBandwidth;
+        page->ringLoad = ringLoad;
+        page->ringBandwidth = ringbandwidth;
+
+        MemoryOperationsHelper::Copy(RFM2gStatisticsCounters(page), counterRead, nOfHosts * sizeof(int32));
+        MemoryOperationsHelper::Copy(RFM2gStatisticsDiagnostics(page), diagnosticData, nOfHosts * sizeof(float32));
+        MemoryOperationsHelper::Copy(RFM2gStatisticsIntegrityFailures(page), integrityFailures, nOfHosts * sizeof(uint32));
+
+        RFM2gStatisticsPublish(statisticsPage, page, statisticsSize);
+    }
 
 }
 
-bool RFM2g::InitializeCounterRead() {
-
-    counterRead = new int32[nOfHosts];
-
-    bool ok = (counterRead != NULL);
-
-    if (ok) {
-        uint32 i = 0u;
+bool RFM2g::GetOptionalSignalIndex(const char8 * const signalName,
+                                   const TypeDescriptor &signalType,
+                                   const uint32 signalElements,
+                                   uint32 &signalIdx) {
+    bool ok = true;
 
-        for (i = 0u; i < nOfHosts; i++) {
-            counterRead[i] = 0;
+    if (GetSignalIndex(signalIdx, signalName)) {
+        ok = (GetSignalType(signalIdx) == signalType);
+        if (!ok) {
+            REPORT_ERROR(ErrorManagement::ParametersError, "The signal %s has a wrong type", signalName);
+        }
+        if (ok) {
+            uint32 numberOfElements = 0u;
+            ok = GetSignalNumberOfElements(signalIdx, numberOfElements);
+            if (ok) {
+                ok = (numberOfElements == signalElements);
+            }
+            if (!ok) {
+                REPORT_ERROR(ErrorManagement::ParametersError, "The signal %s must have %d elements", signalName, signalElements);
+            }
         }
     }
     else {
-        REPORT_ERROR(ErrorManagement::FatalError, "Failed to allocate counterRead");
+        signalIdx = RFM2G_NO_SIGNAL;
     }
 
     return ok;
-
 }
 
-bool RFM2g::InitializeDiagnosticData() {
-
-    diagnosticData = new float32[nOfHosts];
-
-    bool ok = (diagnosticData != NULL);
-
-    if (ok) {
-        uint32 i = 0u;
+inline uint64 RFM2g::PaceCycleStart() {
+    uint64 nowTicks = HighResolutionTimer::Counter();
 
-        for (i = 0u; i < nOfHosts; i++) {
-            diagnosticData[i] = 0;
-        }
+    if (nextCycleTicks == 0u) {
+        nextCycleTicks = nowTicks;
+    }
+    else if (nowTicks >= (nextCycleTicks + masterPeriodTicks)) {
+        //the starts already past are skipped, the timeline is kept
+        uint64 late = (nowTicks - nextCycleTicks) / masterPeriodTicks;
+        nextCycleTicks += late * masterPeriodTicks;
+        pacingSlips += static_cast<uint32>(late);
+        (void) logger.Log(RFM2G_LOG_PACING_SLIP, counterAndTimer[0], static_cast<int32>(late));
     }
     else {
-        REPORT_ERROR(ErrorManagement::FatalError, "Failed to allocate  diagnosticData");
+        WaitUntil(nextCycleTicks);
     }
 
-    return ok;
+    uint64 cycleStartTicks = nextCycleTicks;
+    nextCycleTicks += masterPeriodTicks;
 
+    return cycleStartTicks;
 }
 
-bool RFM2g::InitializeDiagnosticRatio() {
-
-    diagnosticRatio = new float32[nOfHosts];
-
-    bool ok = (diagnosticRatio != NULL);
-
-    if (ok) {
-        uint32 i = 0u;
+inline void RFM2g::WaitUntil(const uint64 ticks) const {
+    while (static_cast<int64>(ticks - HighResolutionTimer::Counter()) > 0) {
+        ;
+    }
+}
 
-        for (i = 0u; i < nOfHosts; i++) {
-            diagnosticRatio[i] = 0;
+inline void RFM2g::DeadlineAccounting(const uint64 triggerNs) {
+    if (masterPeriodNs > 0u) {
+        uint64 completionNs = timeBase.Now();
+        uint64 deadlineNs = triggerNs + masterPeriodNs;
+        if (completionNs > deadlineNs) {
+            deadlineMisses++;
+            lastOverrun = static_cast<float64>(completionNs - deadlineNs) * 1e-9;
+            if (lastOverrun > worstOverrun) {
+                worstOverrun = lastOverrun;
+            }
+            (void) logger.Log(RFM2G_LOG_DEADLINE_MISS, counterAndTimer[0], 0, 0, lastOverrun);
         }
     }
-    else {
-        REPORT_ERROR(ErrorManagement::FatalError, "Failed to allocate  diagnosticRatio");
+}
+
+inline void RFM2g::PushHistory(const int32 cycle) {
+    if (historydepth > 0u) {
+        uint32 slot = static_cast<uint32>(cycle) % historydepth;
+        MemoryOperationsHelper::Copy(inputHistory + slot * inputsize, pInputBuffer, inputsize);
+        historyCounters[slot] = cycle;
+        historyIndex = slot;
     }
+}
 
-    return ok;
+void RFM2g::SelectHostSlots(const HostReadPlan &plan) {
+    uint32 i = 0u;
 
+    for (i = 0u; i < plan.numberOfHostsToRead; i++) {
+        uint32 host = plan.hostsToRead[i];
+        RFM2G_UINT32 firstCounter = 0u;
+        RFM2G_UINT32 secondCounter = 0u;
+        bool ok = PeekRFM32(plan.hostsToReadInfo[host].hostCounterOffset, firstCounter);
+        ok = ok && PeekRFM32(plan.hostsToReadInfo[host].hostCounterOffset + HostSlotStride(plan, host), secondCounter);
+        slotSecond[host] = ok && (static_cast<int32>(secondCounter - firstCounter) > 0);
+        slotCounter[host] = static_cast<int32>(slotSecond[host] ? secondCounter : firstCounter);
+    }
 }
 
-void RFM2g::readRemapping() {
-    void *indexpointerInternal = pInputBufferInternal;
-    void *indexpointerExternal = pInputBuffer;
+void RFM2g::readRemapping(const HostReadPlan &plan,
+                          const bool slotsSelected) {
+    uint8 *internalBuffer = plan.inputBufferInternal;
 
-    int32 i = initialHostToRead;
+    uint32 i = 0u;
 
-    for (i = initialHostToRead; i <= finalHostToRead; i++) {
+    for (i = 0u; i < plan.numberOfHostsToRead; i++) {
 
-        //copy the data of host i from the DMA to the input buffer
-        MemoryOperationsHelper::Copy(indexpointerExternal, indexpointerInternal, hostsToReadInfo[i].hostToReadSize);
+        uint32 host = plan.hostsToRead[i];
+        const HostReadMappingInfo &hostInfo = plan.hostsToReadInfo[host];
 
-        //shift the pointers to the next host (indexpointerExternal) and to the counter of host i (indexpointerInternal)
-        indexpointerInternal = (void*) ((uint8*) indexpointerInternal + hostsToReadInfo[i].hostToReadSize);
-        indexpointerExternal = (void*) ((uint8*) indexpointerExternal + hostsToReadInfo[i].hostToReadSize);
+        int32 *counterPointer = (int32*) (internalBuffer + hostInfo.hostCounterInternalOffset);
 
-        int32 *counterPointer = (int32*) indexpointerInternal;
-        counterRead[i] = *counterPointer;
+        //with PingPongSlots the slot selected before the transfer is the last completed one, the other may be being written
+        //(when replaying, the recorded image is not being written: the newer counter is taken)
+        int32 *slotCounterPointer = (int32*) (internalBuffer + hostInfo.hostSlotCounterInternalOffset);
+        bool secondSlot = false;
+        bool slotIntact = true;
+        if ((hostslots == 2u) && slotsSelected) {
+            secondSlot = slotSecond[host];
+            if (secondSlot) {
+                counterPointer = slotCounterPointer;
+            }
+            //a slot rewritten since its counter was read may have a torn payload
+            slotIntact = (*counterPointer == slotCounter[host]);
+        }
+        else {
+            //compared as in SelectHostSlots, wrap-safe also on the garbage of a recorded frame
+            secondSlot = (static_cast<int32>(static_cast<uint32>(*slotCounterPointer) - static_cast<uint32>(*counterPointer)) > 0);
+            if (secondSlot) {
+                counterPointer = slotCounterPointer;
+            }
+        }
 
-#ifdef _DEBUG
-        //here I print all the counters but not the last one, since it is computed later (the last host may be read only partially)
-        if(i<finalHostToRead)
-        REPORT_ERROR(ErrorManagement::Information, "counter of host  %d:  %d ", i,  counterRead[i]);
-#endif
+        //a host not transferred in this cycle keeps its previous input image
+        bool hostRead = (!freshnessgate || hostFresh[host]) && slotIntact;
+
+        //the CRC covers payload and counter, it can be checked only if the whole payload is read
+        bool hostValid = hostRead;
+        if (hostRead && integritycheck && hostInfo.hostWholeRead) {
+            uint8 *payloadPointer = (uint8*) counterPointer - plan.hostsProtocolInfo[host].hostOutputsize;
+            uint32 *crcPointer = (uint32*) (counterPointer + 1);
+            hostValid = (RFM2gCRC32C::Compute(payloadPointer, plan.hostsProtocolInfo[host].hostOutputsize + sizeof(int32)) == *crcPointer);
+            if (!hostValid) {
+                integrityFailures[host]++;
+            }
+        }
 
-        //shift the pointer indexpointerInternal to the next host
-        indexpointerInternal = (void*) ((uint8*) indexpointerInternal + sizeof(int32));
+        //with the KeepLastGood policy the input buffer and the counter of a corrupted host keep the last good values
+        if (hostValid || (hostRead && !integritykeeplastgood)) {
+            //copy the data of host i from the DMA to the windows
+            uint32 c = 0u;
+            for (c = hostInfo.hostFirstCopy; c < hostInfo.hostFirstCopy + hostInfo.hostNumberOfCopies; c++) {
+                RFM2G_UINT32 copyInternalOffset = secondSlot ? plan.copies[c].copySlotInternalOffset : plan.copies[c].copyInternalOffset;
+                MemoryOperationsHelper::Copy(plan.copies[c].copyDestination, internalBuffer + copyInternalOffset, plan.copies[c].copySize);
+            }
+            counterRead[host] = *counterPointer;
+        }
 
     }
 
-    //here I grab the counter of the last host
-    int32 *lastcounterPointer = (int32*) ((uint8*) indexpointerInternal - sizeof(int32) - hostsToReadInfo[finalHostToRead].hostToReadSize
-            + hostsProtocolInfo[finalHostToRead].hostOutputsize);
-    counterRead[finalHostToRead] = *lastcounterPointer;
-
-#ifdef _DEBUG
-
-
-        REPORT_ERROR(ErrorManagement::Information, "counter of host  %d:  %d ", finalHostToRead,  counterRead[finalHostToRead]);
-
-#endif
-
 }
 
 ErrorManagement::ErrorType RFM2g::SettingDiagnosticProtocol() {
 
     ErrorManagement::ErrorType err;
 
+    //the new plan is built here, outside the RT thread, and taken by Read() at the next cycle
+    (void) planMux.FastLock(TTInfiniteWait, 0.);
 
+    //a plan not yet taken by the RT thread is withdrawn and rebuilt, otherwise the plan not in use is built
+    HostReadPlan *plan = __sync_lock_test_and_set(&pendingPlan, NULL_PTR(HostReadPlan*));
+    if (plan != NULL) {
+        lastPublishedPlan = (plan == &readPlans[0]) ? &readPlans[1] : &readPlans[0];
+    }
+    else {
+        plan = (lastPublishedPlan == &readPlans[0]) ? &readPlans[1] : &readPlans[0];
+    }
 
-
-    err = SetInitialInfo();
+    err = SetInitialInfo(*plan);
 
     if (!err.fatalError) {
-        err.fatalError = !CheckMemoryContiguity();
+        err.fatalError = !CheckMemoryLayout(*plan);
     }
 
     if (!err.fatalError) {
-        err = InternalRFMRemapping();
+        err = InternalRFMRemapping(*plan);
     }
 
     if (!err.fatalError) {
-        err = inputSizeRemapping();
+        err = inputSizeRemapping(*plan);
     }
 
     if (!err.fatalError) {
-        EvaluateDiagnostcRatio();
+        EvaluateDiagnostcRatio(*plan);
+        EvaluateRingLoad(*plan);
+
+        __sync_synchronize();
+        pendingPlan = plan;
+        lastPublishedPlan = plan;
+        REPORT_ERROR(ErrorManagement::Information, "New read plan published, it will be applied at the next cycle");
     }
 
     else {
-        REPORT_ERROR(ErrorManagement::FatalError, "Failed to set the diagnostic protocol");
+        REPORT_ERROR(ErrorManagement::FatalError, "Failed to set the diagnostic protocol, the previous read plan is kept");
     }
 
-
-
+    planMux.FastUnLock();
 
     return err;
 
 }
 
-void RFM2g::EvaluateDiagnostcRatio() {
-
-    int32 i = initialHostToRead;
+void RFM2g::EvaluateRingLoad(HostReadPlan &plan) {
 
-    for (i = initialHostToRead; i <= finalHostToRead; i++) {
-        diagnosticRatio[i] = ((float32) hostsProtocolInfo[i].hostDownsamplefactor) / ((float32) downsamplefactor);
-
-#ifdef _DEBUG
+    uint32 i = 0u;
+    uint32 writingHosts = 0u;
 
+    //each host writes a slot (its output and trailer) every DownSampleFactor master cycles
+    plan.ringLoadPerCycle = 0.0;
+    for (i = 0u; i < nOfHosts; i++) {
+        const HostCounterProcInfo &info = plan.hostsProtocolInfo[i];
+        if ((info.hostOutputsize > 0u) && (info.hostDownsamplefactor > 0u)) {
+            plan.ringLoadPerCycle += static_cast<float64>(info.hostOutputsize + trailersize) / static_cast<float64>(info.hostDownsamplefactor);
+            writingHosts++;
+        }
+    }
 
-        REPORT_ERROR(ErrorManagement::Information, "ratio of the downsamplefactor of host  %d with this host:  %f ", i,  diagnosticRatio[i]);
+    plan.readBytesPerCycle = 0u;
+    for (i = 0u; i < plan.numberOfTransfers; i++) {
+        plan.readBytesPerCycle += plan.transfers[i].transferSize;
+    }
 
-#endif
+    REPORT_ERROR(ErrorManagement::Information, "Ring load %f bytes per master cycle from %d hosts, this node reads %d bytes per cycle", plan.ringLoadPerCycle,
+                 writingHosts, plan.readBytesPerCycle);
 
+    //the master period from the Frequency of this node and its DownSampleFactor
+    if ((period > 0) && (downsamplefactor > 0u)) {
+        float64 masterPeriod = static_cast<float64>(period) * 1e-6 / static_cast<float64>(downsamplefactor);
+        float64 load = plan.ringLoadPerCycle / masterPeriod;
+        if (ringbandwidth > 0.0) {
+            REPORT_ERROR(ErrorManagement::Information, "Ring load %f MB/s, %f %% of the RingBandwidth", load * 1e-6, 100.0 * load / ringbandwidth);
+        }
+        else {
+            REPORT_ERROR(ErrorManagement::Information, "Ring load %f MB/s", load * 1e-6);
+        }
     }
 
 }
 
-void RFM2g::EvaluateDiagnostcData() {
+void RFM2g::EvaluateDiagnostcRatio(HostReadPlan &plan) {
+
+    uint32 i = 0u;
+
+    for (i = 0u; i < plan.numberOfHostsToRead; i++) {
+        uint32 host = plan.hostsToRead[i];
+
+        plan.diagnosticRatio[host] = ((float32) plan.hostsProtocolInfo[host].hostDownsamplefactor) / ((float32) downsamplefactor);
+
+    }
 
-    int32 i = initialHostToRead;
+}
 
-    for (i = initialHostToRead; i <= finalHostToRead; i++) {
-        diagnosticData[i] = counterRead[nodeIdNumber] - diagnosticRatio[i] * counterRead[i];
+void RFM2g::EvaluateDiagnostcData(const HostReadPlan &plan) {
 
-#ifdef _DEBUG
+    uint32 i = 0u;
 
+    for (i = 0u; i < plan.numberOfHostsToRead; i++) {
+        uint32 host = plan.hostsToRead[i];
 
-           REPORT_ERROR(ErrorManagement::Information, "diagnostic data of host  %d:  %f ", i,  diagnosticData[i]);
+        diagnosticData[host] = counterRead[nodeIdNumber] - plan.diagnosticRatio[host] * counterRead[host];
 
-   #endif
+        if (logtrace) {
+            (void) logger.Log(RFM2G_LOG_TRACE_HOST, static_cast<int32>(host), counterRead[host], 0, diagnosticData[host]);
+        }
 
     }
 
@@ -1848,5 +5314,8 @@ void RFM2g::EvaluateDiagnostcData() {
 CLASS_REGISTER(RFM2g, "1.0")
 CLASS_METHOD_REGISTER(RFM2g, StopLLC)
 CLASS_METHOD_REGISTER(RFM2g, SettingDiagnosticProtocol)
+CLASS_METHOD_REGISTER(RFM2g, SendBulkFile)
+CLASS_METHOD_REGISTER(RFM2g, MailboxSendText)
+CLASS_METHOD_REGISTER(RFM2g, PublishParameterFile)
 
 }
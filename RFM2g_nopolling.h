@@ -42,6 +42,9 @@
  WaitDMA = 1// Required if UseDMA=1, if 0 the DataSource launches DMA read/write transactions without waiting for them to be completed. If 1 it waits for them. (see node (2))
  DMABufferSize = 4096// The DMA buffer size
  DMAThreshold = 32// The DMA threshold after which DMA must be used (bytes)
+ MapMemory = 1// Optional, if 1 the RFM memory is mapped in user space and the counter, the trigger and the PIO transfers use direct loads/stores. Default = 0
+ IntegrityCheck = 1// Optional, if 1 a CRC32C of payload and counter is appended to each host segment and verified at each read. Must be the same on all the hosts. Default = 0
+ IntegrityPolicy = KeepLastGood// Optional, KeepLastGood (a corrupted host keeps the last good data) or Flag (the data is used and only counted). Default = KeepLastGood
 
  //Synchronizing = 0 // Optional, if 1 the DataSource synchronizes the calling thread using SPC synchronization protocol, if 0 it doesn't synchronize and only exchanges data. Default = 0
  //BasePeriod = 1e-4 // Required if Synchronizing=1, the base period of the RFM synchronization clock (coming from the RFM master mode)
@@ -52,6 +55,12 @@
  InitRunTime =0// 1000000
 
  NumberOfHosts=3// Mandatory. Number of host on the RFM
+ DiscoveryTimeOut=60// Optional. Time out (in seconds) to wait for all the hosts to publish their protocol data. Default is 60
+ ReadMergeThreshold=1024// Optional. Largest gap (in bytes) between two host segments read in the same RFM transfer. Default is 1024
+ ReadWindows = {// Optional. Further read windows, each read in the signal with the same name
+     Host7 = { HostId = 7 }// the output of the host with NodeIdNumber 7
+     Probes = { ReadOffset = 0x9000 }// the signal size from ReadOffset
+ }
  TimeOut=20// Optional.  Time out (in microseconds) to wait for hosts writing operations. Dafault is 1 second (i.e., 1000000)
 
  NodeIdNumber=0//Required. For the master always NodeIdNumber=0. For the slaves, a consecutive exclusive integer number, from 1 to ... NumberOfHosts-1
@@ -66,6 +75,7 @@
  RealTime = {Type = float64}
  Counters = {Type = uint8 NumberOfElements = 12}
  Diagnostics = {Type = uint8 NumberOfElements = 12}
+ IntegrityFailures = {Type = uint32 NumberOfElements = 3}//Optional, the number of integrity failures of each host
  }
  }
  *
@@ -101,10 +111,32 @@
 /*---------------------------------------------------------------------------*/
 /*                        Project header includes                            */
 /*---------------------------------------------------------------------------*/
-
+#include "RFM2gTimeBase.h"
+#include "RFM2gStatistics.h"
+#include "RFM2gRecorder.h"
+#include "RFM2gLogger.h"
+#include "RFM2gFaultInjector.h"
+#include "RFM2gBulk.h"
+#include "RFM2gMailbox.h"
+#include "RFM2gParameters.h"
+
+//the reserved area header: the master counter, its Time signal (32 bits, copied in the Time signal of the slaves) and the trigger byte
 #define RFM_TRIG_OFFSET      3*sizeof(int)
 #define RFM_ITERATION_OFFSET 0
 #define RFM_TIME_OFFSET      1*sizeof(int)
+//the discovery epoch opened by the master, with RFM_DISCOVERY_CLOSED set when the master has been stopped
+#define RFM_DISCOVERY_EPOCH_OFFSET 4*sizeof(int)
+#define RFM_DISCOVERY_CLOSED 0x80000000u
+//the protocol table header, written by the master before opening the discovery epoch
+#define RFM_TABLE_VERSION_OFFSET 5*sizeof(int)
+#define RFM_TABLE_SIZE_OFFSET    6*sizeof(int)
+#define RFM_TABLE_VERSION        3u
+//the master clock (uint64 ns, CLOCK_MONOTONIC_RAW domain) written at each master step, low word first. It is not RFM_TIME_OFFSET:
+//that word keeps the 32-bit Time signal of the existing configurations, and a clock in ns would wrap there in about 4 s
+#define RFM_RING_TIME_OFFSET     8*sizeof(int)
+//the master epoch, incremented by each node that starts driving the ring counter, and the NodeIdNumber of that node
+#define RFM_MASTER_EPOCH_OFFSET  10*sizeof(int)
+#define RFM_MASTER_NODE_OFFSET   11*sizeof(int)
 
 //here the structure that packs a single host protocol information
 struct HostCounterProcInfo {
@@ -112,21 +144,81 @@ struct HostCounterProcInfo {
     RFM2G_UINT32 hostWriteoffset;
     RFM2G_UINT32 hostOutputsize;
     MARTe::uint32 hostDownsamplefactor;
+    MARTe::uint32 hostSlots; //1, or 2 with PingPongSlots: must be the same on all the hosts
+    MARTe::uint32 hostTableEpoch; //the discovery epoch in which the entry has been written, written last
 };
 
 //here the structure that contains a single host read mapping info
 struct HostReadMappingInfo {
 
-    RFM2G_UINT32 hostToReadOffset;
-    RFM2G_UINT32 hostToReadSize;
+    RFM2G_UINT32 hostToReadOffset; //the lowest RFM offset read of the host
+    RFM2G_UINT32 hostToReadSize; //the bytes of the host copied in all the windows
+    RFM2G_UINT32 hostCounterInternalOffset; //where the counter of the host starts in the internal input buffer
+    RFM2G_UINT32 hostSlotCounterInternalOffset; //with PingPongSlots, where the counter of the second slot starts
+    MARTe::uint32 hostFirstCopy; //the copies of the host are consecutive in the plan
+    MARTe::uint32 hostNumberOfCopies;
+    bool hostWholeRead; //the whole payload is read, the CRC can be checked
+    RFM2G_UINT32 hostCounterOffset; //the RFM offset of the counter of the host
+    MARTe::uint32 hostFirstTransfer; //with FreshnessGate the transfers of the host are consecutive and read only if its counter advanced
+    MARTe::uint32 hostNumberOfTransfers;
+};
+
+//here the structure that contains a single copy from the internal input buffer to a read window
+struct RFMReadCopyInfo {
+
+    RFM2G_UINT32 copyOffset;
+    RFM2G_UINT32 copySize;
+    RFM2G_UINT32 copyInternalOffset;
+    RFM2G_UINT32 copySlotInternalOffset; //with PingPongSlots, the same bytes in the second slot
+    MARTe::uint8 *copyDestination;
+};
+
+//here the structure that contains a read window: a ReadOffset (or the output of a HostId) read in the signal with the window name
+struct ReadWindowInfo {
+
+    RFM2G_UINT32 windowOffset;
+    RFM2G_UINT32 windowSize;
+    MARTe::uint32 windowHostId;
+    MARTe::uint32 windowSignalIdx;
+    MARTe::uint8 *windowBuffer;
+};
+
+//here the structure that contains a single RFM read transfer of a plan
+struct RFMReadTransferInfo {
+
+    RFM2G_UINT32 transferOffset;
+    RFM2G_UINT32 transferSize;
+    RFM2G_UINT32 transferInternalOffset;
+    MARTe::uint32 transferHost; //the host of the first interval of the transfer
+};
+
+//here the structure that contains a complete read plan: the hosts protocol info, the read mapping and the remapped input size
+//a plan is built outside the RT thread and taken as a whole at a cycle boundary
+struct HostReadPlan {
+
+    HostCounterProcInfo *hostsProtocolInfo;
+    HostReadMappingInfo *hostsToReadInfo;
+    MARTe::float32 *diagnosticRatio;
+    MARTe::uint32 *hostsByOffset; //all the hosts, sorted by their RFM offset
+    MARTe::uint32 *hostsToRead; //the hosts that write in the read range, sorted by their RFM offset
+    MARTe::uint32 numberOfHostsToRead;
+    RFMReadTransferInfo *transfers; //the RFM transfers performed each cycle, at most a counter and one per window for each host
+    MARTe::uint32 numberOfTransfers;
+    RFMReadCopyInfo *copies; //the copies to the read windows, grouped by host
+    MARTe::uint32 numberOfCopies;
+    RFM2G_UINT32 inputsizeRemapped;
+    MARTe::uint8 *inputBufferInternal; //where the transfers are read: owned by the plan with programmed IO, the DMA input area otherwise
+    RFM2G_UINT32 inputBufferInternalSize;
+    MARTe::float64 ringLoadPerCycle; //the bytes written on the ring by all the hosts in a master cycle, from the protocol table
+    MARTe::uint32 readBytesPerCycle; //the bytes of all the transfers of the plan
 };
 
 //here the start of the RFM reserved space for the diangostic counter protocol
 #define RFM_START_PROTOCOL      64
 
-#define SIZE_OF_HOST_PROTOCOL_DATA sizeof(HostCounterProcInfo) //in the order:  writeoffset, outputsize, downsamplefactor
+#define SIZE_OF_HOST_PROTOCOL_DATA sizeof(HostCounterProcInfo) //in the order:  writeoffset, outputsize, downsamplefactor, slots, epoch
 
-#define RFM_SYSTEM_BUFFER RFM_START_PROTOCOL+256*SIZE_OF_HOST_PROTOCOL_DATA
+//the reserved space is RFM_START_PROTOCOL+NumberOfHosts*SIZE_OF_HOST_PROTOCOL_DATA, see RFM2g::SystemBufferSize()
 
 /*---------------------------------------------------------------------------*/
 /*                           Class declaration                               */
@@ -139,6 +231,52 @@ namespace MARTe {
 const float64 SLEEP_WAITING_PERIOD = 10.F;
 const float64 TIMEOUT_PERIOD = 1000000.F;
 const int16 MASTERSTEP_MAX_RETRIES = 100;
+const float64 DISCOVERY_TIMEOUT_PERIOD = 60.0;
+const uint32 READ_MERGE_THRESHOLD = 1024u;
+const uint32 CATCHUP_MAX_REPLAY = 10u;
+const float64 TIME_BASE_CALIBRATION_PERIOD = 0.1;
+const uint32 RING_TIME_WINDOW = 100u;
+const uint32 FAILOVER_PERIODS = 10u;
+const uint32 STATISTICS_PERIOD = 100u;
+const uint32 RECORD_BUFFER_CYCLES = 1000u;
+const uint32 LOG_QUEUE_SIZE = 256u;
+const float64 LOG_MIN_INTERVAL = 1.0;
+
+/**
+ * Default size in bytes of the shared memory card stand-in
+ */
+const uint32 SIMULATED_MEMORY_SIZE = 0x1000000u;
+
+/**
+ * Device prefix of the shared memory card stand-in
+ */
+const char8 * const RFM2G_SIMULATED_DEVICE_PREFIX = "shm:";
+
+/**
+ * Milliseconds between two checks of a parked exchange thread
+ */
+const uint32 PARK_WAIT_MS = 100u;
+
+/**
+ * Milliseconds between two checks of the discovery epoch by a running slave
+ */
+const uint32 DISCOVERY_WATCH_MS = 10u;
+
+/**
+ * Default bytes of a bulk blob sent per cycle
+ */
+const uint32 BULK_BYTES_PER_CYCLE = 1024u;
+
+/**
+ * Default slots of a mailbox and bytes of a message
+ */
+const uint32 MAILBOX_SLOTS = 16u;
+const uint32 MAILBOX_MESSAGE_SIZE = 64u;
+
+/**
+ * Minimum master cycles between the publication of a parameter block and its application
+ */
+const uint32 PARAMETER_MIN_APPLY_DELAY = 2u;
 
 /**
  * @brief GE/FANUC-Abaco Systems 5565 Reflective Memory series card  DataSource
@@ -152,7 +290,7 @@ const int16 MASTERSTEP_MAX_RETRIES = 100;
  *     Class = RFM2g
  *     ExecutionMode = IndependentThread //Optional. If not set ExecutionMode = IndependentThread. If ExecutionMode == IndependentThread a thread is spawned to generate the time events. ExecutionMode == RealTimeThread the time is generated in the context of the real-time thread.
  *     CPUMask = 0x8 //Optional and only relevant if ExecutionMode=IndependentThread
- *     Device = /dev/rfm2g0 // Mandatory, the Linux device handling the RFM card installed on the system (see note (3))
+ *     Device = /dev/rfm2g0 // Mandatory, the Linux device handling the RFM card installed on the system (see note (3)), or shm:/name for the stand-in of note (19)
  *     ReadOffset = 800 // Mandatory, the offset in bytes of the read starting point in the RF memory
  *     WriteOffset = 800 // Mandatory, the offset in bytes of the write starting point in the RF memory
  *
@@ -161,6 +299,9 @@ const int16 MASTERSTEP_MAX_RETRIES = 100;
  *     WaitDMA = 1 // Required if UseDMA=1, if 0 the DataSource launches DMA read/write transactions without waiting for them to be completed. If 1 it waits for them. (see node (2))
  *     DMABufferSize = 1024 // Required if UseDMA=1, the size of the userspace DMA buffer, see node (4)
  *     DMAThreshold = 32 // Required, the transfer size above which DMA will be triggered
+ *     MapMemory = 1 // Optional, if 1 the RFM memory is mapped in userspace (see note (6)). Default = 0
+ *     IntegrityCheck = 1 // Optional, if 1 each host segment is protected by a CRC32C (see note (7)). Default = 0
+ *     IntegrityPolicy = KeepLastGood // Optional, KeepLastGood or Flag, what to do with a corrupted host segment. Default = KeepLastGood
  *
  *     //Synchronizing = 0 // Optional, if 1 the DataSource synchronizes the calling thread using SPC synchronization protocol, if 0 it doesn't synchronize and only exchanges data. Default = 0
  *
@@ -176,11 +317,56 @@ const int16 MASTERSTEP_MAX_RETRIES = 100;
  *     //StartTime =  // Required if master mode, the base period in us of the strobe signal (aka us per counter step)
  *     InitRunTime = -10000000 // Required if master mode, time value to be set oin the RFM when mester enters Run
  *     MasterStepMaxRetries = 100 // Required if master mode, the number of retries of failed master steps before giving un (within a cycle)
+ *     MasterPacing = 0 // Optional, master only, if 1 the cycles start on an absolute timeline at the Frequency, see note (24). Default = 0
+ *     PacingStepPhase = 50 // Optional, with MasterPacing=1 the microseconds from the cycle start to the master step. Default = 0
+ *     PacingReadPhase = 250 // Optional, with MasterPacing=1 the microseconds from the cycle start to the read. Default = PacingStepPhase + TimeOut
  *
  *     //InputEnabled = 1  // To be implemented
  *     //Outputenabled = 1 // To be implemented
  *
  *     Cycles = 1000 // Number of cycles before exiting the LLC phase and sending the TermMessage1, see note (5)
+ *     DiscoveryTimeOut = 60 // Optional, seconds to wait for all the hosts in the discovery phase, see note (8). Default = 60
+ *     ReadMergeThreshold = 1024 // Optional, largest gap (bytes) read rather than split in two transfers, see note (9). Default = 1024
+ *     FreshnessGate = 0 // Optional, if 1 only the hosts whose counter advanced are read, see note (16). Default = 0
+ *     LogQueueSize = 256 // Optional, records of the deferred logger queue, see note (18). Default = 256
+ *     LogMinInterval = 1.0 // Optional, minimum seconds between two reports of the same message, the others are counted. Default = 1.0
+ *     LogTrace = 0 // Optional, if 1 a trace record is logged at each cycle. Default = 0
+ *     SimulatedMemorySize = 0x1000000 // Optional, with Device = shm:/name the size in bytes of the shared memory stand-in, see note (19). Default = 0x1000000
+ *     Faults = { // Optional, faults injected on scheduled cycles, see note (19)
+ *         WriteLatency = { Host = 2 Start = 1000 Period = 100 Cycles = 5 Latency = 200 } // Latency in us
+ *         FreezeMaster = { Start = 5000 Cycles = 50 }
+ *     }
+ *     ParkThread = 0 // Optional, ExecutionMode=IndependentThread only, if 1 the thread is parked in Idle instead of being stopped, see note (21). Default = 0
+ *     WarmUpCycles = 0 // Optional, exchange cycles run without publishing data when entering Run, see note (21). Default = 0
+ *     RingBandwidth = 0 // Optional, the sustained ring bandwidth in bytes per second, to report the utilisation, see note (23)
+ *     BulkOffset = 0x200000 // Optional, the RFM offset of the bulk channel regions, see note (25). No bulk channel if not given
+ *     BulkSize = 0x40000 // Required with BulkOffset, the bytes of the region of each host (a multiple of 4, header included)
+ *     BulkBytesPerCycle = 1024 // Optional, the bytes of a blob sent per cycle (a multiple of 4). Default = 1024
+ *     MailboxOffset = 0x100000 // Optional, the RFM offset of the mailboxes, see note (26). No mailbox if not given
+ *     MailboxSlots = 16 // Optional, the messages a mailbox holds (a power of 2). Default = 16
+ *     MailboxMessageSize = 64 // Optional, the maximum bytes of a message (a multiple of 4). Default = 64
+ *     ParameterOffset = 0x300000 // Optional, the RFM offset of the parameter block published by the master, see note (27)
+ *     ParameterSize = 256 // Required with ParameterOffset, the maximum bytes of the parameter block (a multiple of 4)
+ *     HistoryDepth = 0 // Optional, the input images kept in the InputHistory signal, see note (20). Default = 0
+ *     PingPongSlots = 0 // Optional, if 1 each host alternates between two slots of its segment, see note (17). Must be the same on all the hosts. Default = 0
+ *     ReadWindows = { // Optional, further read windows, see note (10)
+ *         Host7 = { HostId = 7 }
+ *         Probes = { ReadOffset = 0x9000 }
+ *     }
+ *     TimeBaseCalibrationPeriod = 0.1 // Optional, seconds of the start-up TSC calibration against CLOCK_MONOTONIC_RAW, see note (12). Default = 0.1
+ *     RingTimeWindow = 100 // Optional, slave only, master cycles per ring time offset estimate. Default = 100
+ *     RingTimeLatency = 0 // Optional, slave only, known ring latency (ns) subtracted from the offset. Default = 0
+ *     Standby = 0 // Optional, slave only, if 1 the node takes over the ring counter when the master stops, see note (13). Default = 0
+ *     FailoverPeriods = 10 // Optional, with Standby=1 the master periods without a new cycle before the takeover. Default = 10
+ *     StatisticsName = "/rfm2g_node1" // Optional, POSIX shared memory name of the statistics page, see note (14)
+ *     StatisticsPeriod = 100 // Optional, cycles between two publications of the statistics page. Default = 100
+ *     Record = "/tmp/node1.rfmrec" // Optional, records the raw input image of each cycle in this file, see note (15)
+ *     RecordBufferCycles = 1000 // Optional, cycles buffered in memory for the record writer thread. Default = 1000
+ *     //Replay = "/tmp/node1.rfmrec" // Optional, takes the inputs from this record file instead of the card, see note (15)
+ *     //ReplayPacing = Recorded // Optional, Recorded (the recorded cycle times) or AsFastAsPossible. Default = Recorded
+ *     CatchUpPolicy = Latest // Optional, slave only, Latest, Replay or Notify, what to do after lost cycles, see note (11). Default = Latest
+ *     CatchUpMaxReplay = 10 // Optional, with CatchUpPolicy=Replay the maximum number of lost cycles replayed. Default = 10
+ *     CatchUpNotifyAfter = 1 // Optional, with CatchUpPolicy=Notify the consecutive cycles with losses before sending the CycleLossMessage. Default = 1
  *
  *     Signals = {
  *         Counter = {
@@ -204,9 +390,90 @@ const int16 MASTERSTEP_MAX_RETRIES = 100;
  *             NumberOfElements = 100
  *             // The output buffer (system -> RFM), the buffer is treated as a contiguous memory segment, size in bytes*
  *         }
+ *         IntegrityFailures = {
+ *             Type = uint32
+ *             NumberOfElements = 3
+ *             // Optional, NumberOfHosts elements, the cumulative number of integrity (CRC32C) failures of each host
+ *         }
+ *         RingTime = {
+ *             Type = float64
+ *             // Optional, the master clock in seconds, estimated on the slaves (0 until the first estimate), see note (12)
+ *         }
+ *         MasterNode = {
+ *             Type = uint32
+ *             // Optional, the NodeIdNumber of the node driving the ring counter, see note (13)
+ *         }
+ *         FailoverTime = {
+ *             Type = float64
+ *             // Optional, standby only, seconds from the last cycle of the lost master to the takeover
+ *         }
+ *         ReadBandwidth = {
+ *             Type = float64
+ *             // Optional, bytes per second read by this node, measured every second, see note (23)
+ *         }
+ *         WriteBandwidth = {
+ *             Type = float64
+ *             // Optional, bytes per second written by this node, measured every second
+ *         }
+ *         RingLoad = {
+ *             Type = float64
+ *             // Optional, bytes per second written on the ring by all the hosts, from the protocol table
+ *         }
+ *         DeadlineMisses = {
+ *             Type = uint32
+ *             // Optional, the cycles whose Read completed after the next master tick, see note (22)
+ *         }
+ *         LastOverrun = {
+ *             Type = float64
+ *             // Optional, seconds past the deadline of the last missed cycle
+ *         }
+ *         WorstOverrun = {
+ *             Type = float64
+ *             // Optional, the worst overrun in seconds since Run
+ *         }
+ *         SkippedCycles = {
+ *             Type = uint32
+ *             // Optional, the master cycles skipped before the current cycle (a multiple of DownSampleFactor)
+ *         }
+ *         LostCycles = {
+ *             Type = uint32
+ *             // Optional, the cumulative number of lost cycles
+ *         }
+ *         LossEvents = {
+ *             Type = uint32
+ *             // Optional, the cumulative number of cycles preceded by a loss
+ *         }
+ *         CycleReplayed = {
+ *             Type = uint8
+ *             // Optional, 1 when the cycle is the replay of a lost one (CatchUpPolicy=Replay)
+ *         }
+ *         InputHistory = {
+ *             Type = uint8
+ *             NumberOfElements = 1000
+ *             // Optional, HistoryDepth times the InputBuffer size, the last HistoryDepth input images, see note (20)
+ *         }
+ *         HistoryCounters = {
+ *             Type = int32
+ *             NumberOfElements = 10
+ *             // Optional, HistoryDepth elements, the cycle of each image in InputHistory
+ *         }
+ *         HistoryIndex = {
+ *             Type = uint32
+ *             // Optional, the slot of InputHistory holding the current image
+ *         }
+ *         Parameters = {
+ *             Type = uint8
+ *             NumberOfElements = 256
+ *             // Optional, ParameterSize elements, the parameter block in force, see note (27)
+ *         }
+ *         ParameterVersion = {
+ *             Type = uint32
+ *             // Optional, the version of the parameter block in force (0: none)
+ *         }
  *     }
  *
  *     +TermMessage1 = { Class=Message Destination=StateMachine Function=RUNCOMPLETE }
+ *     +CycleLossMessage = { Class=Message Destination=StateMachine Function=CYCLELOSS } // Required with CatchUpPolicy=Notify, after the TermMessage1
  * }
  * </pre>
  *
@@ -263,6 +530,126 @@ const int16 MASTERSTEP_MAX_RETRIES = 100;
  *     so messages are passed and a shot cycle could be done without problems. Anyway SPAWNED
  *     thread on a dedicated CPU is working w/o problems and should be preferred.
  * (5) Only valid in slave - synchronizing mode
+ * (6) With MapMemory=1 the whole RFM memory is mapped once via RFM2gUserMemoryBytes. The iteration counter, the trigger flag,
+ *     the master step, the time word and the data transfers below DMAThreshold (all of them when UseDMA=0) are performed
+ *     with direct volatile loads/stores, fenced with memory barriers, instead of a driver call per access.
+ *     Transfers above DMAThreshold keep using DMA when UseDMA=1.
+ * (7) With IntegrityCheck=1 each host appends, after its counter, the CRC32C of its payload and counter (SSE4.2 crc32 instruction
+ *     when available, slicing-by-8 otherwise), so the per host trailer becomes 8 bytes. The CRC is verified in readRemapping() for the hosts
+ *     whose segment is whole read. With IntegrityPolicy=KeepLastGood a corrupted (torn) segment is not copied and the host keeps
+ *     its last good data and counter, with IntegrityPolicy=Flag it is used anyway. In both cases it is counted in IntegrityFailures.
+ * (8) Discovery: each protocol table entry carries the discovery epoch in which it has been written (written last). The master opens
+ *     a new epoch at start-up (RFM_DISCOVERY_EPOCH_OFFSET) and closes it when destroyed. SettingDiagnosticProtocol waits, polling every
+ *     millisecond and reporting the progress every second, until all the NumberOfHosts entries carry the current epoch. A host started
+ *     before the master joins the new epoch as soon as it is opened, so the discovery completes as soon as the last host arrives.
+ *     A running slave (also parked or driving the ring as standby) checks the epoch word every DISCOVERY_WATCH_MS and stamps
+ *     its entry again when a restarted master opens a new epoch.
+ *     The protocol table has NumberOfHosts entries, so the reserved area (ReadOffset and WriteOffset lower bound) is
+ *     64+20*NumberOfHosts bytes. The master writes the table version and size (RFM_TABLE_VERSION_OFFSET, RFM_TABLE_SIZE_OFFSET)
+ *     before opening the epoch, the discovery fails if they do not match the ones of this host.
+ * (9) The host segments (data and trailer) may leave gaps and need not follow the NodeIdNumber order, they must only not overlap.
+ *     The read plan browses the hosts in RFM order and reads the data in the read range and the counters of the intersected hosts
+ *     in a list of transfers; two consecutive intervals are read in a single transfer when the gap between them is not greater than
+ *     ReadMergeThreshold. The input buffer keeps the layout of the read range, the bytes in the gaps are zero.
+ * (10) Besides the InputBuffer at ReadOffset, further read windows can be listed in ReadWindows. Each window has either a ReadOffset
+ *     or a HostId (the window starts at the WriteOffset published by that host) and is read in the signal with the window name,
+ *     whose size in bytes gives the window size. The intervals needed by all the windows are merged as in note (9), so that
+ *     a node reading the hosts 1 and 7 does not read the hosts in between.
+ * (11) A slave detects the lost cycles when the master counter jumps by more than DownSampleFactor between two processed cycles.
+ *     SkippedCycles gives the master cycles skipped before each cycle, LostCycles and LossEvents the cumulative losses.
+ *     With CatchUpPolicy=Latest only the latest cycle is processed. With Replay, Synchronise returns once for each lost cycle
+ *     (up to CatchUpMaxReplay) with its Counter, the latest inputs and CycleReplayed=1, and then once for the latest cycle.
+ *     With Notify the CycleLossMessage is sent after CatchUpNotifyAfter consecutive cycles with losses.
+ * (12) RealTime and RingTime use the TSC frequency measured against CLOCK_MONOTONIC_RAW in Initialise and refined every second
+ *     over the whole baseline. The master publishes its clock at each step (RFM_RING_TIME_OFFSET); a slave timestamps each new
+ *     master cycle when detected and takes the minimum delay over RingTimeWindow cycles as its offset from the master.
+ * (13) With Standby=1 a slave watches the ring counter: when it does not change for FailoverPeriods master periods (Frequency
+ *     and DownSampleFactor give the master period) the node publishes a new master epoch with its NodeIdNumber
+ *     (RFM_MASTER_EPOCH_OFFSET, RFM_MASTER_NODE_OFFSET) and drives rfm_master_step() from the last counter plus one at the
+ *     master pace, on an absolute timeline from the takeover (the cycle waits for each step). The ring time continues the one
+ *     of the lost master, a master period per step, so the slaves' ring time does not jump. The master publishes a new epoch
+ *     when it enters Run, and the standby then steps back.
+ * (14) With StatisticsName the DataSource publishes every StatisticsPeriod cycles a seqlock protected page (RFM2gStatistics.h)
+ *     with counters, diagnostics, integrity failures, phase timings, master step retries and lost cycles. The writer never
+ *     blocks; the stand-alone RFM2gStatsViewer reads it: RFM2gStatsViewer /rfm2g_node1 [refresh period in seconds].
+ * (15) With Record each cycle's raw internal input image (the merged transfers, counters included) is copied with the Counter,
+ *     the Time and a timestamp in a ring of RecordBufferCycles slots; a background thread writes it to the file, a cycle that finds
+ *     the ring full is dropped and counted. The protocol table is recorded whenever a new read plan is taken. With Replay the card
+ *     is not opened: the read plans are built from the recorded tables and each cycle is taken from the file, paced at the recorded
+ *     times (ReplayPacing=Recorded) or as fast as possible. The replaying node must have the same NumberOfHosts, IntegrityCheck and
+ *     read windows of the recording one. At the end of the file the TermMessage is sent and the inputs are frozen.
+ * (16) With FreshnessGate=1 the transfers are built per host (never merged across hosts). Each cycle a host becomes due when the
+ *     ring iteration crosses a multiple of its DownSampleFactor (from the protocol table); only the counters of the due hosts are
+ *     read and only the hosts whose counter differs from the last one read are transferred and remapped. The other hosts keep
+ *     their previous input image. A host late on its schedule stays due until its new counter is seen.
+ * (17) With PingPongSlots=1 each host segment holds two slots (payload and trailer) and the host writes them alternately, so the
+ *     segment takes 2*(output size + trailer) bytes from its WriteOffset shifted by the trailers. Before the transfers the two
+ *     counters of each host are read and the slot with the newer one (the last completed) is selected; the plan reads both
+ *     slots and readRemapping takes the selected one, whose copy offsets are in the plan. The other slot may be being written
+ *     and is never used. The counter of the selected slot is checked again after the transfer: if it changed, the host fell a
+ *     whole cycle behind and keeps its previous input image. The setting is published in the protocol table: the discovery
+ *     fails if the hosts disagree. In DMA mode the DMA buffer must hold both slots of the read windows.
+ * (18) The real-time cycle does not call REPORT_ERROR: it pushes fixed size records in a lock-free queue (RFM2gLogger) that a
+ *     low priority thread formats. Each message is reported at most once every LogMinInterval seconds, with the number of
+ *     records suppressed in between; a record that finds the queue full is dropped. With LogTrace=1 the counters are traced
+ *     at each cycle, also in production builds.
+ * (19) With Device = shm:/name the card is replaced by a POSIX shared memory of SimulatedMemorySize bytes mapped as with
+ *     MapMemory=1 (UseDMA is ignored), so that several nodes run on one machine; the segment is left for the other nodes and
+ *     is removed with rm /dev/shm/name. The Faults block injects faults on the cycles (Counter) of the node: WriteLatency and
+ *     DMADelay busy wait Latency us before the write and after each DMA transfer (DMADelay needs UseDMA=1 on a card, it is
+ *     refused on the stand-in), Jitter in Synchronise; DropWrite skips the
+ *     write, StaleCounter writes the payload with the previous counter, CorruptCounter flips the counter after the CRC and
+ *     FreezeMaster stops the ring counter. Each fault has Start, Period (0: once), Cycles (default 1) and an optional Host
+ *     (NodeIdNumber), so that all the nodes can share the same block.
+ * (20) With HistoryDepth=N the InputBuffer image of each cycle is also stored in the slot (cycle % N) of a ring of N images,
+ *     exposed by the InputHistory signal with the cycle of each slot (HistoryCounters) and the current slot (HistoryIndex), so
+ *     that the GAMs filtering over past remote samples do not keep their own copies. The brokers bind the signal addresses
+ *     once, so the InputBuffer itself cannot be rotated: the ring costs one copy of the image per cycle. The broker of a GAM
+ *     reading InputHistory copies the whole signal, HistoryDepth * InputBuffer size bytes per cycle: a GAM needing only the
+ *     latest samples reads InputBuffer, and reads InputHistory only where the past images are used. A slot not written
+ *     because of a lost cycle keeps an older image, recognisable by its counter.
+ * (21) Stopping the exchange thread in Idle costs, at each Run, the thread creation, its placement and cold caches. With
+ *     ParkThread=1 the thread waits on a semaphore in Idle (checking every PARK_WAIT_MS) and is released at the end of Run,
+ *     after the state reset. The transition to Idle waits for the thread to park (up to 10 PARK_WAIT_MS plus the TimeOut)
+ *     and stops it if it does not. WarmUpCycles cycles (the bus locked for one cycle at a time) read the transfers of the current plan and write the zeroed output, without
+ *     remapping nor publishing, at the start of the first cycle after Run (the first Run has no plan yet: only the write).
+ * (22) The deadline of a cycle is the next master tick: the time the master stepped the counter (on a slave, the ring time
+ *     the master published with the counter, moved to the own clock by the estimated offset (12), or the time the new counter
+ *     was seen until the offset is estimated) plus the master period given by the Frequency and the DownSampleFactor. A cycle whose Read
+ *     completes later is a deadline miss: DeadlineMisses, LastOverrun and WorstOverrun are exposed as signals and in the
+ *     statistics page, and the miss is logged (rate limited). Without a Frequency there is no deadline.
+ * (23) When a read plan is built the theoretical ring load is computed from the protocol table: the sum over the hosts of
+ *     (output size + trailer) / DownSampleFactor bytes per master cycle. It is reported, in bytes per second at the master
+ *     period, with the utilisation of RingBandwidth if given. At run time the bytes actually transferred by this node are
+ *     measured every second (ReadBandwidth, WriteBandwidth) and published with the load (RingLoad) in the statistics page.
+ * (24) Without MasterPacing the master cycle starts when the RT thread calls Synchronise and the TimeOut before the read is
+ *     counted from the end of the step, so any jitter of the caller or of the write moves all the following ticks. With
+ *     MasterPacing=1 the cycle k starts at start + k * period (the Frequency of the master, on the TSC), the master step at
+ *     PacingStepPhase and the read at PacingReadPhase from the cycle start: the Synchronise blocks until the cycle start and
+ *     the jitter does not accumulate. A master late by more than a period skips the missed starts, keeping the timeline;
+ *     the skips are logged. Both phases must be within the period.
+ * (25) The bulk channel moves large blobs (e.g. controller matrices) without touching the cycle budget. Each host has a
+ *     region of BulkSize bytes at BulkOffset + NodeIdNumber * BulkSize (above the reserved area and clear of the data
+ *     segments, checked against the own data segment and the ReadOffset windows): a header (RFM2gBulk.h) and the blob. SendBulk() (or the SendBulkFile message) queues a blob; the cycle
+ *     writes at most BulkBytesPerCycle bytes of it with programmed IO, then the bytes written and the fragment sequence.
+ *     A low priority thread follows the regions the other hosts announced (the channel word), reads the new fragments and checks the CRC32C of a
+ *     complete blob; GetBulk() returns the last complete blob of a host. A blob is sent only when the previous is done.
+ * (26) The mailboxes pass discrete messages (events, commands) between the nodes. There is one for each ordered pair of
+ *     hosts at MailboxOffset + (Source * NumberOfHosts + Destination) * (8 + MailboxSlots * (4 + MailboxMessageSize)), above
+ *     the reserved area and clear of the data segments (as the bulk regions): the header (RFM2gMailbox.h) and the slots. The sender writes the
+ *     slot and then advances head, the receiver reads the slot and then advances tail, so only plain RFM reads and writes are
+ *     needed. MailboxSend() and MailboxReceive() never block and can be called by the GAMs in the cycle or by other threads
+ *     (MailboxSendText message); a second thread posting to (or receiving from) the same host at the same time gets false,
+ *     the mailboxes of the other hosts have their own locks. At Initialise the
+ *     mailboxes to this host are emptied, the messages left by a previous run are dropped.
+ * (27) The master publishes a versioned parameter block (PublishParameters() or the PublishParameterFile message) at
+ *     ParameterOffset, above the reserved area and clear of the data segments: the header (RFM2gParameters.h) with the
+ *     master cycle from which the block applies, and the block. Each node, the master included, reads the version word
+ *     every cycle (the only steady state cost), reads and checks the block once when the version changes and copies it
+ *     in the Parameters signal on its first cycle at or after the apply cycle, so all the nodes switch on the same master
+ *     cycle. A node started later takes the block in force at Initialise. The delay must leave the slaves a cycle to
+ *     read the block: at least PARAMETER_MIN_APPLY_DELAY and the largest DownSampleFactor of the protocol table + 1, or
+ *     the publication is refused; a block read after its apply cycle is applied at once and logged.
  *
  */
 
@@ -370,33 +757,161 @@ public:CLASS_REGISTER_DECLARATION()
     bool SetDiagnosticOwnData();
 
     /**
-     * @brief check if the RFM allocation of the master and all the hosts is contiguous, i.e, there are no holes in the memory segment
-     * @return true if the allocation is contiguous and all the hosts writes according to the order given by their NodeIdNumber. Otherwise return false
+     * @brief writes on the RFM the host own protocol table entry, stamped with the given discovery epoch
+     * @details the epoch word is invalidated first and written last, so that readers never see a valid partially written entry
+     * @return true if the writing operations have been successful
      */
-    bool CheckMemoryContiguity();
+    bool StampDiagnosticOwnData(const RFM2G_UINT32 epoch);
+
+    /**
+     * @brief sorts the hosts by their RFM offset and checks that their segments (data and trailer) do not overlap
+     * @details gaps between the segments and any ordering of the NodeIdNumber are allowed
+     * @return true if no segments overlap. Otherwise return false
+     */
+    bool CheckMemoryLayout(HostReadPlan &plan);
+
+    /**
+     * @brief the RFM offset of the segment (data and trailer) written by the host
+     */
+    RFM2G_UINT32 HostSegmentOffset(const HostReadPlan &plan,
+                                   const uint32 host) const;
+
+    /**
+     * @brief the size of the RFM reserved area: the system words and the protocol table of NumberOfHosts entries
+     */
+    RFM2G_UINT32 SystemBufferSize() const;
+
+    /**
+     * @brief the space reserved in the internal input buffer for the gaps read when merging the transfers
+     */
+    RFM2G_UINT32 ReadMergeSlack() const;
+
+    /**
+     * @brief the maximum number of RFM intervals of a plan: a counter and one per window for each slot of each host
+     */
+    uint32 MaxReadIntervals() const;
+
+    /**
+     * @brief the distance between the two slots of a host with PingPongSlots: its output and trailer
+     */
+    RFM2G_UINT32 HostSlotStride(const HostReadPlan &plan,
+                                const uint32 host) const;
+
+    /**
+     * @brief adds the RFM interval [start, start+size) to the transfers of the plan, kept sorted by RFM offset
+     */
+    void AddReadInterval(HostReadPlan &plan,
+                         const RFM2G_UINT32 start,
+                         const RFM2G_UINT32 size,
+                         const uint32 host);
+
+    /**
+     * @brief merges the overlapping intervals and those separated by a gap not greater than readmergethreshold, then lays the transfers in the internal input buffer
+     * @details with FreshnessGate the intervals of different hosts are never merged
+     */
+    void MergeReadIntervals(HostReadPlan &plan);
+
+    /**
+     * @brief the offset in the internal input buffer of an RFM offset read by the plan
+     */
+    RFM2G_UINT32 InternalOffsetOf(const HostReadPlan &plan,
+                                  const RFM2G_UINT32 offset) const;
 
     /**
      * @brief set the information of the other hosts from RFM to implement the diagnostic counter protocol
+     * @details waits (up to discoveryTimeOut) until all the hosts entries are valid in the current discovery epoch
      */
-    ErrorManagement::ErrorType SetInitialInfo();
+    ErrorManagement::ErrorType SetInitialInfo(HostReadPlan &plan);
 
     /**
      * @brief do a re-mapping of the RFM writing regions taking into account the counter for each host
+     * @details the hosts intersecting the read range are browsed in RFM order and their data and counters are collected in the fewest transfers
      */
-    ErrorManagement::ErrorType InternalRFMRemapping();
+    ErrorManagement::ErrorType InternalRFMRemapping(HostReadPlan &plan);
 
     /**
-     * @brief computes the remapped size to be read (the sum of the size to be read of all the hosts from initialHostToRead until finalHostToRead plus the counters)
+     * @brief computes the remapped size to be read (the sum of the transfers, i.e. the data and the counters of the hosts to read plus the merged gaps)
+     * @details fails if the remapped input does not fit the buffers allocated in AllocateMemory
      */
-    ErrorManagement::ErrorType inputSizeRemapping();
+    ErrorManagement::ErrorType inputSizeRemapping(HostReadPlan &plan);
 
     /**
      * @brief launch the functions: SetInitialInfo; InternalRFMRemapping; inputSizeRemapping so as to set the diagnostic counter protocol
+     * @details The new read plan is built in the plan not used by the RT thread and published, Read() takes it at the next cycle.
+     * It can be called at any time (also in the Run state) to re-layout the ring, without allocations nor locks in the RT thread.
+     * If it fails the previous plan is kept.
      */
     ErrorManagement::ErrorType SettingDiagnosticProtocol();
 
     ErrorManagement::ErrorType StopLLC();
 
+    /**
+     * @brief Queues a blob on the bulk channel, see note (25). Not real-time: the blob is copied.
+     * @return false if the channel is disabled, still sending the previous blob or the blob does not fit the region.
+     */
+    bool SendBulk(const void * const blob,
+                  const uint32 size);
+
+    /**
+     * @brief Queues the content of a file on the bulk channel (registered method).
+     */
+    ErrorManagement::ErrorType SendBulkFile(StreamString fileName);
+
+    /**
+     * @brief Copies the last complete blob received from host.
+     * @param[out] size the size of the blob.
+     * @param[out] blobId the identifier of the blob, 0 if none has been received yet.
+     * @return false if the channel is disabled or the blob does not fit in bufferSize bytes.
+     */
+    bool GetBulk(const uint32 host,
+                 void * const buffer,
+                 const uint32 bufferSize,
+                 uint32 &size,
+                 uint32 &blobId);
+
+    /**
+     * @brief Posts a message to the mailbox of destination, see note (26). Never blocks.
+     * @return false if the mailboxes are disabled, the mailbox is full, the message is too large or another thread is posting
+     * to the same destination.
+     */
+    bool MailboxSend(const uint32 destination,
+                     const void * const message,
+                     const uint32 size);
+
+    /**
+     * @brief Takes the oldest message from the mailbox of source. Never blocks.
+     * @param[out] size the size of the message, also when it does not fit in bufferSize bytes (the message is then left in the mailbox).
+     * @return false if the mailboxes are disabled, the mailbox is empty, the message does not fit or another thread is receiving
+     * from the same source.
+     */
+    bool MailboxReceive(const uint32 source,
+                        void * const buffer,
+                        const uint32 bufferSize,
+                        uint32 &size);
+
+    /**
+     * @brief Posts a text message to the mailbox of destination (registered method).
+     */
+    ErrorManagement::ErrorType MailboxSendText(uint32 destination,
+                                               StreamString text);
+
+    /**
+     * @brief Publishes a new version of the parameter block, applied by all the nodes applyDelay master cycles from now,
+     * see note (27). Master only, not real-time.
+     * @return false if not master, the broadcast is disabled, the block is larger than ParameterSize, applyDelay is less
+     * than PARAMETER_MIN_APPLY_DELAY or than the largest DownSampleFactor of the protocol table + 1, or the previous
+     * version is not applied yet.
+     */
+    bool PublishParameters(const void * const block,
+                           const uint32 size,
+                           const uint32 applyDelay);
+
+    /**
+     * @brief Publishes the content of a file as the new parameter block (registered method).
+     */
+    ErrorManagement::ErrorType PublishParameterFile(StreamString fileName,
+                                                    uint32 applyDelay);
+
 private:
 
     /**
@@ -414,6 +929,103 @@ private:
      */
     SingleThreadService executor;
 
+    /**
+     * With ParkThread the exchange thread is parked on parkSem in Idle instead of being stopped.
+     * parked is set by PrepareNextState, threadParked by the thread when it is waiting
+     */
+    bool parkthread;
+    volatile bool parked;
+    volatile bool threadParked;
+    EventSem parkSem;
+
+    /**
+     * The exchange cycles run without publishing data when entering Run, and the ones still to be run
+     */
+    uint32 warmupcycles;
+    uint32 warmUpRemaining;
+
+    /**
+     * The bulk channel: the regions (one per host, from bulkoffset) and the bytes sent per cycle
+     */
+    bool bulkenabled;
+    RFM2G_UINT32 bulkoffset;
+    uint32 bulksize;
+    uint32 bulkbytespercycle;
+
+    /**
+     * The blob being sent: set by SendBulk, sent by the RT thread while bulkTxPending
+     */
+    uint8 *bulkTxBuffer;
+    uint32 bulkTxSize;
+    uint32 bulkTxSent;
+    uint32 bulkTxCRC;
+    uint32 bulkTxId;
+    uint32 bulkTxFragments;
+    volatile bool bulkTxPending;
+
+    /**
+     * The reassembly of the blobs of the hosts, by a low priority thread, and the last complete ones
+     */
+    RFM2gBulkReceiveState *bulkRx;
+    uint8 *bulkRxAssembly;
+    uint8 *bulkRxComplete;
+    FastPollingMutexSem bulkMux;
+    pthread_t bulkReceiver;
+    bool bulkReceiverStarted;
+    volatile bool bulkReceiving;
+
+    /**
+     * The mailboxes: one for each ordered pair of hosts, from mailboxoffset
+     */
+    bool mailboxenabled;
+    RFM2G_UINT32 mailboxoffset;
+    uint32 mailboxslots;
+    uint32 mailboxmessagesize;
+
+    /**
+     * The heads of the mailboxes to the other hosts and the tails of those from them, as last written, and per other
+     * host the slot being posted and the locks that keep a single producer and a single consumer on each mailbox
+     */
+    uint32 *mailboxTxHead;
+    uint32 *mailboxRxTail;
+    uint8 *mailboxTxSlot;
+    FastPollingMutexSem *mailboxTxMux;
+    FastPollingMutexSem *mailboxRxMux;
+
+    /**
+     * The parameter broadcast: the region at parameteroffset and the maximum bytes of the block
+     */
+    bool parametersenabled;
+    RFM2G_UINT32 parameteroffset;
+    uint32 parametersize;
+
+    /**
+     * The block in force (Parameters signal) and its version (ParameterVersion signal), the block read from the RFM
+     * waiting for its apply cycle and the last version read
+     */
+    uint8 *parameters;
+    uint32 parameterVersion;
+    uint8 *parameterStaging;
+    bool parameterStaged;
+    uint32 parameterStagedVersion;
+    int32 parameterApplyCycle;
+    uint32 parameterSeenVersion;
+    uint32 parameterFailures;
+
+    /**
+     * The master side: the block being published, the last version published and its apply cycle
+     */
+    uint8 *parameterPublishing;
+    uint32 parameterPublished;
+    int32 parameterPublishedApply;
+    FastPollingMutexSem parameterMux;
+
+    /**
+     * Indexes of the optional parameter signals
+     */
+    uint32 parametersSignalIdx;
+    uint32 parameterVersionSignalIdx;
+
     /**
      * Index of the function which has the signal that synchronises on this DataSourceI.
      */
@@ -489,6 +1101,26 @@ private:
      */
     bool waitdma;
 
+    /**
+     * Map the RFM memory in userspace for direct PIO access
+     */
+    bool mapmemory;
+
+    /**
+     * RFM memory mapped in userspace
+     */
+    bool rfmmapped;
+
+    /**
+     * Userspace pointer to the mapped RFM memory
+     */
+    volatile uint8 *pRfmMemory;
+
+    /**
+     * Size in bytes of the RFM memory (of the card even if not mapped, of the shared memory if simulated, 0 when replaying)
+     */
+    RFM2G_UINT32 rfmmemorysize;
+
     /**
      * Base period of the synchronizing strobe
      */
@@ -556,7 +1188,7 @@ private:
     void *pOutputBuffer;
 
     /**
-     * Input buffer for internal data exchange (decoupling buffer)
+     * Input buffer for internal data exchange (decoupling buffer), the DMA input area shared by the read plans (unused with programmed IO)
      */
     void *pInputBufferInternal;
     /**
@@ -602,29 +1234,34 @@ private:
     RFM2G_NODE NodeId;
 
     /**
-     * pointer to hosts info for diagnostic counter protocol
+     * the two read plans (hosts info, read mapping and remapped input size), one used by the RT thread and one to build the next
      */
-    HostCounterProcInfo *hostsProtocolInfo;
+    HostReadPlan readPlans[2];
 
     /**
-     * pointer to reading info of the hosts to be read
+     * the read plan used by the RT thread (only accessed by the RT thread)
      */
-    HostReadMappingInfo *hostsToReadInfo;
+    HostReadPlan *activePlan;
 
     /**
-     * host number of the first host to be read
+     * the read plan published by SettingDiagnosticProtocol and not yet taken by the RT thread
      */
-    int32 initialHostToRead;
+    HostReadPlan * volatile pendingPlan;
 
     /**
-     * host number of the last host to be read
+     * the last read plan published (only accessed by SettingDiagnosticProtocol)
      */
-    int32 finalHostToRead;
+    HostReadPlan *lastPublishedPlan;
 
     /**
-     * inputsize taking into account the size of all the hosts to be read, from  initialHostToRead until finalHostToRead and all their the counters
+     * Semaphore to serialise the SettingDiagnosticProtocol calls (never taken by the RT thread)
      */
-    RFM2G_UINT32 inputsizeRemapped;
+    FastPollingMutexSem planMux;
+
+    /**
+     * size in bytes of the DMA input area, the upper bound of the inputsizeRemapped of any plan in DMA mode
+     */
+    RFM2G_UINT32 inputbufferinternalsize;
 
     /**
      * vector containing the counters of the hosts read (from the RFM reading operation)
@@ -638,12 +1275,112 @@ private:
      */
     float32 *diagnosticData;
 
+
     /**
-     * vector containing the ratio of each of the downsamplefactor of the other hosts over the downsamplefactor of this host
-     * The ratio is used in the function EvaluateDiagnostcData().
-     * The diagnosticRatio is an optional output of the RFM
+     * CRC32C integrity check of the host segments enabled
      */
-    float32 *diagnosticRatio;
+    bool integritycheck;
+
+    /**
+     * If true a corrupted host segment is discarded and the last good data is kept, otherwise it is only counted
+     */
+    bool integritykeeplastgood;
+
+    /**
+     * Size in bytes of the trailer appended to each host segment (counter and, if integritycheck, CRC32C)
+     */
+    RFM2G_UINT32 trailersize;
+
+    /**
+     * vector containing the number of integrity failures of each host
+     * The integrityFailures is an optional output of the RFM
+     */
+    uint32 *integrityFailures;
+
+    /**
+     * Index of the optional IntegrityFailures signal
+     */
+    uint32 integrityFailuresSignalIdx;
+
+    /**
+     * The discovery epoch in which this host entry has been stamped
+     */
+    RFM2G_UINT32 discoveryepoch;
+
+    /**
+     * Seconds to wait for all the hosts in the discovery phase
+     */
+    float64 discoveryTimeOut;
+
+    /**
+     * The largest gap (in bytes) read rather than split in two RFM transfers
+     */
+    uint32 readmergethreshold;
+
+    /**
+     * The deferred logger used in the real-time cycle and the LogTrace flag (a record per cycle)
+     */
+    RFM2gLogger logger;
+    bool logtrace;
+
+    /**
+     * The fault injector and a flag set if at least one fault is configured for this node
+     */
+    RFM2gFaultInjector faults;
+    bool faultsenabled;
+
+    /**
+     * The counter of the last stamp written, kept by the StaleCounter fault
+     */
+    int32 stampedCounter;
+
+    /**
+     * The RFM memory is the shared memory stand-in (Device = shm:/name)
+     */
+    bool simulatedcard;
+
+    /**
+     * The slots of each host segment: 1, or 2 with PingPongSlots
+     */
+    uint32 hostslots;
+
+    /**
+     * With PingPongSlots, the slot written at the next cycle
+     */
+    uint32 writeSlot;
+
+    /**
+     * With PingPongSlots, the last completed slot of each host and its counter, taken before the transfers
+     */
+    bool *slotSecond;
+    int32 *slotCounter;
+
+    /**
+     * With FreshnessGate only the hosts whose counter advanced are transferred and remapped
+     */
+    bool freshnessgate;
+
+    /**
+     * The hosts expected to publish (from their DownSampleFactor) whose new counter has not been seen yet
+     */
+    bool *hostDue;
+
+    /**
+     * The hosts transferred in the current cycle
+     */
+    bool *hostFresh;
+
+    /**
+     * The ring iteration of the last gated cycle
+     */
+    int32 lastGateIteration;
+
+    /**
+     * The read windows, the first one is the InputBuffer at ReadOffset
+     */
+    uint32 numberOfReadWindows;
+    ReadWindowInfo *readWindows;
+    StreamString *readWindowNames;
 
     /**
      * Semaphore to manage the buffer indexes.
@@ -661,11 +1398,89 @@ private:
      */
 
     /**
-     * @brief Initialize the vector hostsToReadInfo at null values
-     * @details First the vector hostsToReadInfo is dynamically allocated with the number of hosts and then it is initialized
+     * @brief Initialize the two read plans at null values
+     * @details First the vectors of both the plans are dynamically allocated with the number of hosts and then they are initialized
      * @return true
      */
-    bool InitializeHostsToReadInfo();
+    bool InitializeReadPlans();
+
+    /**
+     * @brief increments the master epoch and publishes this node as the one driving the ring counter
+     * @return true if the RFM operations succeeded
+     */
+    bool PublishMasterEpoch();
+
+    /**
+     * @brief the standby takes over the stalled master: publishes a new master epoch and continues the counter from the last one seen
+     * @param[in] nowTicks the time of the detection
+     */
+    void StandbyTakeOver(const uint64 nowTicks);
+
+    /**
+     * @brief writes the next ring counter (rfm_master_step) when a master period has elapsed, while driving the ring
+     * @details steps back to standby if another node has published a newer master epoch
+     */
+    void StandbyMasterStep();
+
+    /**
+     * @brief On a running slave, stamps again the own protocol table entry when the master opens a new discovery epoch
+     * @details checked at most every DISCOVERY_WATCH_MS, from the cycle and while parked, so that a restarted master completes
+     * its discovery without waiting for a SettingDiagnosticProtocol on the slaves
+     */
+    void WatchDiscoveryEpoch();
+
+    /**
+     * @brief reads the master clock (ns) published with the current master cycle, false if not published or torn
+     */
+    bool ReadMasterRingTime(uint64 &masterNs);
+
+    /**
+     * @brief updates the estimate of the offset from the master clock with the master cycle written at masterNs and detected at detectionNs
+     * @details the offset is the minimum of (detection - master write) over ringtimewindow samples, smoothed across the windows
+     */
+    void RingTimeSample(const uint64 detectionNs,
+                        const uint64 masterNs);
+
+    /**
+     * @brief accounts the cycles lost by the slave since the previous processed cycle and applies the catch-up policy
+     * @param[in] previousCounterEmbedded the counterEmbedded of the previous processed cycle
+     */
+    void CycleLossAccounting(const int32 previousCounterEmbedded);
+
+    /**
+     * @brief creates the statistics page (StatisticsName) in POSIX shared memory, if configured
+     * @return false if the page is configured and cannot be created
+     */
+    bool InitializeStatistics(StructuredDataI &data);
+
+    /**
+     * @brief updates the cycle timings and, every statisticsperiod cycles, publishes the statistics page (seqlock, never blocks)
+     */
+    void PublishStatistics();
+
+    /**
+     * @brief reads the Record and Replay parameters and opens the replay file
+     * @return false if both are given or the replay file does not match this node
+     */
+    bool InitializeRecordReplay(StructuredDataI &data);
+
+    /**
+     * @brief takes the read plan published by SettingDiagnosticProtocol, if any, at the cycle boundary
+     * @return true if a new plan has been taken
+     */
+    bool TakePendingPlan();
+
+    /**
+     * @brief replaces the card cycle when replaying: takes the next cycle from the record file and remaps it
+     */
+    ErrorManagement::ErrorType ReplayStep();
+
+    /**
+     * @brief reads the ReadWindows block, the InputBuffer at ReadOffset is always the first window
+     * @details each window has either a HostId or a ReadOffset, its size is given by the signal with the window name
+     * @return true if all the windows are valid
+     */
+    bool InitializeReadWindows(StructuredDataI &data);
 
     /**
      * @brief Initialize the vector counterRead at null values
@@ -682,19 +1497,72 @@ private:
     bool InitializeDiagnosticData();
 
     /**
-     * @brief Initialize the vector diagnosticRatio at null values
-     * @details First the vector diagnosticRatio is dynamically allocated with the number of hosts and then it is initialized
+     * @brief Initialize the vector integrityFailures at null values
+     * @details First the vector integrityFailures is dynamically allocated with the number of hosts and then it is initialized
      * @return true
      */
-    bool InitializeDiagnosticRatio();
+    bool InitializeIntegrityFailures();
+
+    /**
+     * @brief Registers the messages of the real-time cycle in the deferred logger and starts its thread
+     */
+    bool InitializeLogger(StructuredDataI &data);
+
+    /**
+     * @brief Allocates the hostDue and hostFresh vectors used by FreshnessGate
+     */
+    bool InitializeFreshnessGate();
+
+    /**
+     * @brief Allocates the slotSecond and slotCounter vectors used by PingPongSlots
+     */
+    bool InitializeHostSlots();
+
+    /**
+     * @brief Stores the current input image in the history ring, at the slot of the cycle
+     */
+    inline void PushHistory(const int32 cycle);
+
+    /**
+     * @brief Creates or opens the shared memory card stand-in and maps it as the RFM memory
+     */
+    bool InitializeSimulatedCard(StructuredDataI &data);
+
+    /**
+     * @brief Reads the optional Faults block
+     */
+    bool InitializeFaults(StructuredDataI &data);
+
+    /**
+     * @brief With FreshnessGate decides the hosts to transfer in this cycle
+     * @details A host is due when a multiple of its DownSampleFactor has been crossed by the ring iteration since the last cycle,
+     * and stays due until its counter is seen advanced. Only the counters of the due hosts are read.
+     */
+    void GateFreshHosts(const HostReadPlan &plan);
+
+    /**
+     * @brief Looks for an optional signal by name and checks its type and number of elements
+     * @param[out] signalIdx the index of the signal if configured, RFM2G_NO_SIGNAL otherwise
+     * @return false if the signal is configured with a wrong type or number of elements
+     */
+    bool GetOptionalSignalIndex(const char8 * const signalName,
+                                const TypeDescriptor &signalType,
+                                const uint32 signalElements,
+                                uint32 &signalIdx);
 
     /**
      * @brief computes the vector of diagnosticRatio
      * @details The value is computed performing, for each host actually read, the ratio among its downsamplefactor and the
      *  downsamplefactor of this host.
-     *  The vector diagnosticRatio is used in the function EvaluateDiagnostcData();
+     *  The vector diagnosticRatio of the plan is used in the function EvaluateDiagnostcData();
+     */
+    void EvaluateDiagnostcRatio(HostReadPlan &plan);
+
+    /**
+     * @brief Computes the theoretical ring load of the plan: each host writes its output and trailer once every
+     * DownSampleFactor master cycles. Reported with the utilisation of RingBandwidth, if given.
      */
-    void EvaluateDiagnostcRatio();
+    void EvaluateRingLoad(HostReadPlan &plan);
 
     /**
      * @brief computes the vector of diagnosticData
@@ -703,7 +1571,7 @@ private:
      * If the value is positive, the other host data is old (an it is older than the downsamplefactor ratio, than it is outdated).
      * Conversely, if the value is negative, than this host is delayed.
      */
-    void EvaluateDiagnostcData();
+    void EvaluateDiagnostcData(const HostReadPlan &plan);
 
     /**
      * @brief Get the current value of the iteration counter
@@ -745,22 +1613,213 @@ private:
      * @return true if the iteration could be safely written
      */
     bool rfm_master_step(int32 rfm_iter,
-                         int32 time);
+                         int32 time,
+                         uint64 ringTimeNs);
+
+    /**
+     * @brief Reads a byte from the RFM, directly from the mapped memory if available
+     */
+    inline bool PeekRFM8(RFM2G_UINT32 offset,
+                         uint8 &value);
+
+    /**
+     * @brief Reads a 32 bit word from the RFM, directly from the mapped memory if available
+     */
+    inline bool PeekRFM32(RFM2G_UINT32 offset,
+                          RFM2G_UINT32 &value);
+
+    /**
+     * @brief Writes a byte on the RFM, directly on the mapped memory if available
+     */
+    inline bool PokeRFM8(RFM2G_UINT32 offset,
+                         uint8 value);
+
+    /**
+     * @brief Writes a 32 bit word on the RFM, directly on the mapped memory if available
+     */
+    inline bool PokeRFM32(RFM2G_UINT32 offset,
+                          RFM2G_UINT32 value);
+
+    /**
+     * @brief Reads size bytes from the RFM offset into buffer
+     * @details Uses the mapped memory for PIO transfers and for DMA transfers below dmathreshold, otherwise DMA.
+     * The transfer mode is a template parameter, so that each cycle variant tests only what its configuration needs.
+     */
+    template<bool mapped, bool dma, bool waitDMA>
+    inline bool ReadRFM(RFM2G_UINT32 offset,
+                        void *buffer,
+                        RFM2G_UINT32 size);
+
+    /**
+     * @brief Writes size bytes from buffer to the RFM offset
+     * @details Uses the mapped memory for PIO transfers and for DMA transfers below dmathreshold, otherwise DMA
+     */
+    template<bool mapped, bool dma, bool waitDMA>
+    inline bool WriteRFM(RFM2G_UINT32 offset,
+                         void *buffer,
+                         RFM2G_UINT32 size);
+
+    /**
+     * @brief Writes the host counter (and its CRC32C if integritycheck) after the payload in the internal output buffer
+     */
+    inline void StampOutputTrailer(const int32 hostCounter);
 
     /**
      * @brief Reads the inputbuffer from the relfective memory local memory
      */
+    template<bool mapped, bool dma, bool waitDMA>
     ErrorManagement::ErrorType Read(ExecutionInfo &info);
 
     /**
      * @brief Writes the outputbuffer to the relfective memory local memory
      */
+    template<bool mapped, bool dma, bool waitDMA>
     ErrorManagement::ErrorType Write(ExecutionInfo &info);
 
+    /**
+     * @brief Reads the bulk channel options, allocates its buffers and starts the receiver thread
+     */
+    bool InitializeBulkChannel(StructuredDataI &data);
+
+    /**
+     * @brief Checks that the region [regionStart, regionEnd) of the named feature is clear of the own data segment (both
+     * slots with PingPongSlots) and of the read windows given by a ReadOffset
+     * @details called from SetConfiguredDatabase, when the signals give the sizes of the segment and of the windows
+     */
+    bool RegionClearOfData(const char8 * const regionName,
+                           const uint64 regionStart,
+                           const uint64 regionEnd) const;
+
+    /**
+     * @brief Reads the mailbox options, checks the region and resynchronises the mailboxes of this host
+     */
+    bool InitializeMailboxes(StructuredDataI &data);
+
+    /**
+     * @brief Reads the parameter options and the block in force, so that all the nodes start with the same parameters
+     */
+    bool InitializeParameters(StructuredDataI &data);
+
+    /**
+     * @brief Reads the parameter block once its version changes and applies it from its apply cycle, see note (27)
+     */
+    template<bool mapped>
+    inline void ParameterUpdate(const int32 ringCycle);
+
+    /**
+     * @brief Reads the parameter block in parameterStaging, false if torn by a new publication
+     * @param[out] valid false if the block is too large or its CRC does not match.
+     */
+    template<bool mapped>
+    bool FetchParameters(const uint32 version,
+                         bool &valid);
+
+    /**
+     * @brief The RFM offset of the mailbox from source to destination
+     */
+    inline RFM2G_UINT32 MailboxAddress(const uint32 source,
+                                       const uint32 destination) const;
+
+    /**
+     * @brief The bytes of a slot (the size word and the message)
+     */
+    inline uint32 MailboxSlotSize() const;
+
+    /**
+     * @brief Posts a message to the mailbox of destination, see MailboxSend().
+     * @return RFM2G_MAILBOX_POSTED, or why the message has not been posted.
+     */
+    uint8 MailboxPost(const uint32 destination,
+                      const void * const message,
+                      const uint32 size);
+
+    /**
+     * @brief The capacity in bytes of a bulk region (without its header)
+     */
+    inline uint32 BulkCapacity() const;
+
+    /**
+     * @brief Writes the next fragment (at most BulkBytesPerCycle bytes) of the blob being sent
+     */
+    template<bool mapped>
+    void BulkSendFragment();
+
+    /**
+     * @brief Sends the messages requested by the real-time thread, called by the logger thread after each pass
+     */
+    static void PostPendingMessages(void *dataSource);
+
+    /**
+     * @brief The receiver thread body and a pass over the regions of the other hosts
+     */
+    static void *BulkReceiverThread(void *dataSource);
+    void BulkReceive();
+
+    /**
+     * @brief Waits for the start of the next cycle on the MasterPacing timeline and returns it
+     */
+    inline uint64 PaceCycleStart();
+
+    /**
+     * @brief Busy waits until the tick given (HighResolutionTimer)
+     */
+    inline void WaitUntil(const uint64 ticks) const;
+
+    /**
+     * @brief Checks the completion of the cycle against the next master tick after triggerNs
+     */
+    inline void DeadlineAccounting(const uint64 triggerNs);
+
+    /**
+     * @brief Runs the remaining warm-up cycles: the transfers of the active plan and the write of the zeroed output,
+     * without remapping nor publishing, so that the first real cycle finds the data path hot
+     */
+    template<bool mapped, bool dma, bool waitDMA>
+    void WarmUp();
+
+    /**
+     * @brief The master cycle: write, master step, wait and read
+     */
+    template<bool mapped, bool dma, bool waitDMA>
+    ErrorManagement::ErrorType MasterCycle(ExecutionInfo &info);
+
+    /**
+     * @brief The slave cycle: wait for the master counter, then write, wait and read according to the DownSampleFactor (synchronising slaves only, checked by SetConfiguredDatabase)
+     */
+    template<bool spawned, bool mapped, bool dma, bool waitDMA>
+    ErrorManagement::ErrorType SlaveCycle(ExecutionInfo &info);
+
+    /**
+     * @brief The cycle when replaying a record file, see ReplayStep
+     */
+    ErrorManagement::ErrorType ReplayCycle(ExecutionInfo &info);
+
+    /**
+     * @brief Selects the cycle instantiation for the role and thread model, given the transfer mode
+     */
+    template<bool mapped, bool dma, bool waitDMA>
+    void SelectCycle();
+
+    /**
+     * @brief Selects, once in Initialise, the cycle instantiation for the role, the thread model and the transfer mode
+     */
+    void SelectCycle();
+
+    /**
+     * The cycle called by Execute
+     */
+    ErrorManagement::ErrorType (RFM2g::*cycleFunction)(ExecutionInfo &info);
+
     /**
      * @brief this function remap the read data into the memory pointed by pInputBuffer
      */
-    void readRemapping();
+    void readRemapping(const HostReadPlan &plan,
+                       const bool slotsSelected);
+
+    /**
+     * @brief With PingPongSlots reads the two counters of each host to read and selects its last completed slot, see note (17)
+     */
+    void SelectHostSlots(const HostReadPlan &plan);
 
     /**
      * First synchronization happened
@@ -778,9 +1837,209 @@ private:
 
     int32 period;
 
+    /**
+     * The time (ns) of the first cycle, RealTime is measured from it
+     */
     uint64 realTimeOffset;
 
     float64 realTime;
+
+    /**
+     * The TSC time base calibrated against CLOCK_MONOTONIC_RAW
+     */
+    RFM2gTimeBase timeBase;
+
+    /**
+     * The master clock (seconds): the own clock for the master, the own clock minus the estimated offset for the slaves
+     */
+    float64 ringTime;
+
+    /**
+     * The estimated offset (ns) of this clock from the master one, the minimum of the current window and its number of samples
+     */
+    int64 ringTimeOffset;
+    int64 ringTimeWindowMin;
+    uint32 ringTimeSamples;
+    bool ringTimeValid;
+
+    /**
+     * The samples per estimation window and the known ring latency (ns) subtracted from each sample
+     */
+    uint32 ringtimewindow;
+    int64 ringtimelatency;
+
+    /**
+     * The last master iteration seen, only consecutive iterations give a ring time sample
+     */
+    int32 lastSeenIteration;
+
+    /**
+     * Index of the optional RingTime signal
+     */
+    uint32 ringTimeSignalIdx;
+
+    /**
+     * True if this slave is the standby master, true while it drives the ring counter after a failover
+     */
+    bool standby;
+    bool standbyDriving;
+
+    /**
+     * The master periods without a new cycle after which the standby takes over, and the same in ticks
+     */
+    uint32 failoverperiods;
+    uint64 failoverTicks;
+
+    /**
+     * The expected master period, from the Frequency and the DownSampleFactor of this node
+     */
+    uint64 masterPeriodTicks;
+    float64 masterPeriodUs;
+
+    /**
+     * The master period in ns, the deadline of a cycle after the master tick that triggered it
+     */
+    uint64 masterPeriodNs;
+
+    /**
+     * MasterPacing: the master cycles start at start + k * masterPeriodTicks, the step and the read at fixed phases (us in
+     * the configuration, ticks at Run) from the cycle start. nextCycleTicks is the start of the next cycle (0 before the
+     * first one) and pacingSlips the cycle starts skipped because the master was late by more than a period
+     */
+    bool masterpacing;
+    float64 pacingstepphase;
+    float64 pacingreadphase;
+    uint64 pacingStepPhaseTicks;
+    uint64 pacingReadPhaseTicks;
+    uint64 nextCycleTicks;
+    uint32 pacingSlips;
+
+    /**
+     * The cycles completed after their deadline, the overrun (s) of the last one and the worst overrun
+     */
+    uint32 deadlineMisses;
+    float64 lastOverrun;
+    float64 worstOverrun;
+
+    /**
+     * Indexes of the optional deadline signals
+     */
+    uint32 deadlineMissesSignalIdx;
+    uint32 lastOverrunSignalIdx;
+    uint32 worstOverrunSignalIdx;
+
+    /**
+     * When the ring counter changed last and whether it has been seen running
+     */
+    uint64 lastIterationTicks;
+    bool iterationSeen;
+
+    /**
+     * When a running slave checks again the discovery epoch
+     */
+    uint64 discoveryWatchTicks;
+
+    /**
+     * The next step, the counter, the time and the ring time (ns, the timeline of the lost master) written while driving the ring
+     */
+    uint64 nextStepTicks;
+    int32 drivingIteration;
+    float64 drivingTime;
+    uint64 drivingRingNs;
+
+    /**
+     * The master epoch published by this node, the node driving the ring and the last failover time (s)
+     */
+    RFM2G_UINT32 masterEpoch;
+    uint32 masterNode;
+    float64 failoverTime;
+
+    /**
+     * Indexes of the optional MasterNode and FailoverTime signals
+     */
+    uint32 masterNodeSignalIdx;
+    uint32 failoverTimeSignalIdx;
+
+    /**
+     * The name of the POSIX shared memory statistics page and the cycles between two publications
+     */
+    StreamString statisticsname;
+    uint32 statisticsperiod;
+
+    /**
+     * The shared statistics page, the private copy filled before the seqlock publication and their size
+     */
+    RFM2gStatisticsPage *statisticsPage;
+    RFM2gStatisticsPage *statisticsScratch;
+    uint32 statisticsSize;
+
+    /**
+     * Cycles processed since Run and cumulative rfm_master_step retries
+     */
+    uint64 statisticsCycles;
+    uint32 masterStepRetries;
+
+    /**
+     * Last and maximum durations (ticks) of the write and read phases and of the cycle
+     */
+    uint64 writeTicks;
+    uint64 readTicks;
+    uint64 cycleTicks;
+    uint64 lastCycleTicks;
+
+    /**
+     * The bytes read and written by this node since bandwidthTicks, the rates (bytes/s) measured on the last second,
+     * the theoretical ring load (bytes/s) and the configured ring bandwidth (bytes/s, 0 if not given)
+     */
+    uint64 bytesRead;
+    uint64 bytesWritten;
+    uint64 bandwidthTicks;
+    float64 readBandwidth;
+    float64 writeBandwidth;
+    float64 ringLoad;
+    float64 ringbandwidth;
+
+    /**
+     * Indexes of the optional bandwidth signals
+     */
+    uint32 readBandwidthSignalIdx;
+    uint32 writeBandwidthSignalIdx;
+    uint32 ringLoadSignalIdx;
+    uint64 writeTicksMax;
+    uint64 readTicksMax;
+    uint64 cycleTicksMax;
+
+    /**
+     * The record and replay files, the record ring size (cycles) and the replay pacing
+     */
+    StreamString recordfile;
+    StreamString replayfile;
+    uint32 recordbuffercycles;
+    bool replaypaced;
+
+    /**
+     * True when the inputs are recorded or taken from the record file instead of the card
+     */
+    bool recording;
+    bool replaying;
+
+    /**
+     * The record file writer and reader
+     */
+    RFM2gRecorder recorder;
+
+    /**
+     * The last protocol table read from the record file
+     */
+    HostCounterProcInfo *replayTable;
+    bool replayTableValid;
+
+    /**
+     * The timestamp of the first replayed cycle and the time it has been replayed
+     */
+    bool replayStarted;
+    uint64 replayFirstNs;
+    uint64 replayStartNs;
     /**
      * Ok to run to the polling synch parts
      */
@@ -801,6 +2060,65 @@ private:
      */
     int32 counterEmbedded;
 
+    /**
+     * The catch-up policy of the slave (Latest, Replay or Notify) and its parameters
+     */
+    uint8 catchuppolicy;
+    uint32 catchupmaxreplay;
+    uint32 catchupnotifyafter;
+
+    /**
+     * The message sent after catchupnotifyafter consecutive cycles with losses (Notify policy)
+     */
+    ReferenceT<Message> lossMessage;
+
+    /**
+     * The loss message requested by the real-time thread, sent by the logger thread
+     */
+    volatile bool lossMessagePending;
+
+    /**
+     * Master cycles skipped before the current cycle, cumulative number of lost cycles and of cycles with losses
+     */
+    uint32 skippedCycles;
+    uint32 lostCycles;
+    uint32 lossEvents;
+
+    /**
+     * 1 when the current cycle is the replay of a lost one (Replay policy)
+     */
+    uint8 cycleReplayed;
+
+    /**
+     * Consecutive cycles with losses, cycles still to be run by Synchronise (Replay policy) and whether a cycle has been processed yet
+     */
+    uint32 consecutiveLosses;
+    uint32 replayCycles;
+    bool cycleLossArmed;
+
+    /**
+     * Indexes of the optional cycle loss signals
+     */
+    uint32 skippedCyclesSignalIdx;
+    uint32 lostCyclesSignalIdx;
+    uint32 lossEventsSignalIdx;
+    uint32 cycleReplayedSignalIdx;
+
+    /**
+     * The ring of the last historydepth input images, the cycle of each image and the slot of the current one
+     */
+    uint32 historydepth;
+    uint8 *inputHistory;
+    int32 *historyCounters;
+    uint32 historyIndex;
+
+    /**
+     * Indexes of the optional history signals
+     */
+    uint32 inputHistorySignalIdx;
+    uint32 historyCountersSignalIdx;
+    uint32 historyIndexSignalIdx;
+
     int32 test;
 
     /**
@@ -813,6 +2131,11 @@ private:
      */
     bool termmsgsent;
 
+    /**
+     * The termination message requested by the real-time thread, sent by the logger thread
+     */
+    volatile bool termMessagePending;
+
     /**
      * Init time to be broadcast by the master when entering the run state
      */